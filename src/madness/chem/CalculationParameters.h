@@ -65,6 +65,7 @@ struct CalculationParameters : public QCCalculationParametersBase {
 		initialize<double>("charge",0.0,"total molecular charge");
 		initialize<std::string> ("xc","hf","XC input line");
 		initialize<std::string> ("hfexalg","multiworld","hf exchange algorithm: choose from multiworld (default), smallmem, largemem");
+		initialize<double> ("hfexscreen",0.0,"skip exchange pairs with product bound below hfexscreen*thresh, 0 disables screening");
 		initialize<double>("smear",0.0,"smearing parameter");
 		initialize<double>("econv",1.e-5,"energy convergence");
 		initialize<double>("dconv",1.e-4,"density convergence");
@@ -196,6 +197,7 @@ struct CalculationParameters : public QCCalculationParametersBase {
 	std::string ac_data() const {return get<std::string>("ac_data");}
 	std::string xc() const {return get<std::string>("xc");}
         std::string hfexalg() const {return get<std::string>("hfexalg");}
+        double hfexscreen() const {return get<double>("hfexscreen");}
 
 	std::string aobasis() const {return get<std::string>("aobasis");}
 
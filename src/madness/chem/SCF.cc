@@ -1328,7 +1328,7 @@ vecfuncT SCF::apply_potential(World& world, const tensorT& occ,
 	  K.set_algorithm(Exchange<double,3>::Algorithm::small_memory);
 	}
 	
-        K.set_symmetric(true).set_printlevel(param.print_level());
+        K.set_symmetric(true).set_printlevel(param.print_level()).set_screening(param.hfexscreen());
         vecfuncT Kamo = K(amo);
         tensorT excv = inner(world, Kamo, amo);
         double exchf = 0.0;
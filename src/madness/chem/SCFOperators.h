@@ -140,6 +140,9 @@ public:
 
     Exchange& set_printlevel(const long& level);
 
+    /// skip orbital pairs whose product is bounded by less than factor*thresh; 0 disables screening
+    Exchange& set_screening(const double factor);
+
     Exchange& set_taskq(std::shared_ptr<MacroTaskQ> taskq1) {
         this->taskq=taskq1;
         return *this;
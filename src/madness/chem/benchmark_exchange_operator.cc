@@ -2,6 +2,7 @@
 #include <madness.h>
 #include <madness/chem/SCF.h>
 #include <madness/chem/SCFOperators.h>
+#include <madness/chem/exchangeoperator.h>
 #include <madness/chem/nemo.h>
 #include <madness/chem/write_test_input.h>
 #include <madness/misc/info.h>
@@ -9,12 +10,92 @@
 
 using namespace madness;
 
+/// geometry block of a linear alkane C_nH_{2n+2} in the all-trans conformation (in Angstrom)
+std::string alkane_geometry(const int n) {
+    const double dx = 1.257, dy = 0.444;       // zigzag of the carbon backbone, C-C 1.54 A
+    const double hy = 0.63, hz = 0.89;          // methylene hydrogens, C-H 1.09 A
+    std::stringstream ss;
+    ss << "geometry\n";
+    ss << "units angs\n";
+    ss << "no_orient true\n";
+    ss << std::fixed << std::setprecision(4);
+    for (int i = 0; i < n; ++i) {
+        const double x = i * dx;
+        const double s = (i % 2 == 0) ? -1.0 : 1.0;
+        ss << "c " << x << " " << s * dy << " 0.0\n";
+        ss << "h " << x << " " << s * (dy + hy) << " " << hz << "\n";
+        ss << "h " << x << " " << s * (dy + hy) << " " << -hz << "\n";
+    }
+    // terminal hydrogens along the chain direction
+    const double s_last = ((n - 1) % 2 == 0) ? -1.0 : 1.0;
+    ss << "h " << -1.03 << " " << -dy - 0.36 << " 0.0\n";
+    ss << "h " << (n - 1) * dx + 1.03 << " " << s_last * (dy + 0.36) << " 0.0\n";
+    ss << "end\n";
+    return ss.str();
+}
+
+/// compute the exchange operator for localized orbitals of linear alkanes of increasing length,
+/// with and without screening of negligible orbital pairs
+int benchmark_alkanes(World& world, const int nmax, const double screening) {
+    if (world.rank() == 0) {
+        print("\nexchange operator for linear alkanes, screening factor", screening);
+        print("   n  nocc   time(full)  time(screened)   pairs computed/skipped   error");
+    }
+    for (int n = 1; n <= nmax; ++n) {
+        CalculationParameters param;
+        param.set_user_defined_value("econv", 1.e-5);
+        std::vector<double> protocol{1.e-4};
+        param.set_user_defined_value("protocol", protocol);
+        param.set_user_defined_value("localize", std::string("boys"));
+
+        const std::string filename = "alkane_input";
+        if (world.rank() == 0) {
+            std::ofstream of(filename);
+            write_test_input::write_to_test_input("dft", &param, of);
+            of << alkane_geometry(n);
+        }
+        world.gop.fence();
+        commandlineparser parser;
+        parser.set_keyval("input", filename);
+
+        SCF calc(world, parser);
+        calc.set_protocol<3>(world, 1.e-4);
+        MolecularEnergy me(world, calc);
+        me.value(calc.molecule.get_all_coords());
+
+        Exchange<double, 3> K = Exchange<double, 3>(world, &calc, 0);
+        K.set_algorithm(Exchange<double, 3>::multiworld_efficient);
+        K.set_symmetric(true);
+
+        double wall0 = wall_time();
+        const vecfuncT reference = K(calc.amo);
+        double wall1 = wall_time();
+        K.set_screening(screening);
+        const vecfuncT Kamo = K(calc.amo);
+        double wall2 = wall_time();
+        auto [ncomputed, nskipped] = Exchange<double, 3>::ExchangeImpl::get_pair_statistics(world);
+        double err = norm2(world, reference - Kamo);
+        if (world.rank() == 0)
+            printf("%4d %5ld %10.2fs %14.2fs %14ld/%-8ld %10.2e\n", n, calc.amo.size(), wall1 - wall0, wall2 - wall1,
+                   ncomputed, nskipped, err);
+        if (world.rank() == 0) std::remove(filename.c_str());
+    }
+    return 0;
+}
+
 int main(int argc, char** argv) {
     commandlineparser parser(argc,argv);
     madness::initialize(argc, argv);
     {
         madness::World world(SafeMPI::COMM_WORLD);
-        {
+        if (parser.key_exists("alkanes")) {
+            // scaling with the system size: --alkanes=nmax [--screening=0.1]
+            world.gop.fence();
+            startup(world, argc, argv, true);
+            const int nmax = std::stoi(parser.value("alkanes"));
+            const double screening = parser.key_exists("screening") ? std::stod(parser.value("screening")) : 0.1;
+            benchmark_alkanes(world, nmax, screening);
+        } else {
 
             world.gop.fence();
             startup(world, argc, argv, true);
@@ -22,6 +103,7 @@ int main(int argc, char** argv) {
             if (world.rank() == 0) print(info::print_revision_information());
 
             commandlineparser parser(argc, argv);
+
             if (not parser.key_exists("structure")) parser.set_keyval("structure","water2");
             CalculationParameters param;
             param.set_user_defined_value("econv",1.e-6);
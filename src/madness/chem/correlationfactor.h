@@ -244,6 +244,50 @@ private:
 	///				by the correlation factor minus the nuclear potential
 	virtual double Spp_div_S(const double& r, const double& Z) const = 0;
 
+	/// S for the distances of a batch of points to a nucleus
+
+	/// The default calls S() for each point; override with a loop that
+	/// the compiler can vectorize.
+	virtual void S_vec(const double* r, const double Z, double* result, const long npt) const {
+		for (long i=0; i<npt; ++i) result[i]=S(r[i],Z);
+	}
+
+	/// Sr_div_S for the distances of a batch of points to a nucleus
+	virtual void Sr_div_S_vec(const double* r, const double Z, double* result, const long npt) const {
+		for (long i=0; i<npt; ++i) result[i]=Sr_div_S(r[i],Z);
+	}
+
+	/// Spp_div_S for the distances of a batch of points to a nucleus
+	virtual void Spp_div_S_vec(const double* r, const double Z, double* result, const long npt) const {
+		for (long i=0; i<npt; ++i) result[i]=Spp_div_S(r[i],Z);
+	}
+
+	/// distance vectors of a batch of points to a nucleus and their lengths
+	static void distance_vec(const Vector<double*,3>& xvals, const Atom& atom,
+			double* dx, double* dy, double* dz, double* r, const long npt) {
+		const double* x=xvals[0];
+		const double* y=xvals[1];
+		const double* z=xvals[2];
+		for (long i=0; i<npt; ++i) {
+			dx[i]=x[i]-atom.x;
+			dy[i]=y[i]-atom.y;
+			dz[i]=z[i]-atom.z;
+			r[i]=sqrt(dx[i]*dx[i] + dy[i]*dy[i] + dz[i]*dz[i]);
+		}
+	}
+
+	/// adds -factor*Sr_div_S times a component of the smoothed unit vector to result
+	void add_U1_vec(const Vector<double*,3>& xvals, const Atom& atom, const int axis,
+			const double factor, double* result, const long npt) const {
+		std::vector<double> dx(npt), dy(npt), dz(npt), r(npt), sr(npt);
+		distance_vec(xvals,atom,dx.data(),dy.data(),dz.data(),r.data(),npt);
+		Sr_div_S_vec(r.data(),atom.q,sr.data(),npt);
+		for (long i=0; i<npt; ++i) {
+			const coord_3d vr1A{dx[i],dy[i],dz[i]};
+			result[i]-=factor*sr[i]*smoothed_unitvec(vr1A)[axis];
+		}
+	}
+
 public:
 
 	/// first derivative of the NCF with respect to the relative distance rho
@@ -451,6 +495,27 @@ public:
 			}
 
 		}
+
+		bool supports_vectorized() const {return true;}
+
+		void operator()(const Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+			std::vector<double> dx(npts), dy(npts), dz(npts), r(npts), s(npts);
+			for (int i=0; i<npts; ++i) fvals[i]=1.0;
+			for (size_t iatom=0; iatom<ncf->molecule.natom(); ++iatom) {
+				const Atom& atom=ncf->molecule.get_atom(iatom);
+				distance_vec(xvals,atom,dx.data(),dy.data(),dz.data(),r.data(),npts);
+				ncf->S_vec(r.data(),atom.q,s.data(),npts);
+				for (int i=0; i<npts; ++i) fvals[i]*=s[i];
+			}
+			if (exponent==-1) {
+				for (int i=0; i<npts; ++i) fvals[i]=1.0/fvals[i];
+			} else if (exponent==2) {
+				for (int i=0; i<npts; ++i) fvals[i]*=fvals[i];
+			} else if (exponent!=1) {
+				for (int i=0; i<npts; ++i) fvals[i]=std::pow(fvals[i],double(exponent));
+			}
+		}
+
 		std::vector<coord_3d> special_points() const {
 			return ncf->molecule.get_all_coords_vec();
 		}
@@ -480,6 +545,15 @@ public:
 			}
 			return result;
 		}
+
+		bool supports_vectorized() const {return true;}
+
+		void operator()(const Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+			for (int i=0; i<npts; ++i) fvals[i]=0.0;
+			for (size_t i=0; i<ncf->molecule.natom(); ++i) {
+				ncf->add_U1_vec(xvals,ncf->molecule.get_atom(i),axis,1.0,fvals,npts);
+			}
+		}
 		std::vector<coord_3d> special_points() const {
 			return ncf->molecule.get_all_coords_vec();
 		}
@@ -510,6 +584,13 @@ public:
             return ncf->Sr_div_S(r,Z)*ncf->smoothed_unitvec(vr1A)[axis];
         }
 
+        bool supports_vectorized() const {return true;}
+
+        void operator()(const Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+            for (int i=0; i<npts; ++i) fvals[i]=0.0;
+            ncf->add_U1_vec(xvals,ncf->molecule.get_atom(iatom),axis,-1.0,fvals,npts);
+        }
+
         std::vector<coord_3d> special_points() const {
             std::vector< madness::Vector<double,3> > c(1);
             const Atom& atom=ncf->molecule.get_atom(iatom);
@@ -577,6 +658,19 @@ public:
 			}
 			return result;
 		}
+
+		bool supports_vectorized() const {return true;}
+
+		void operator()(const Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+			std::vector<double> dx(npts), dy(npts), dz(npts), r(npts), s(npts);
+			for (int i=0; i<npts; ++i) fvals[i]=0.0;
+			for (size_t iatom=0; iatom<ncf->molecule.natom(); ++iatom) {
+				const Atom& atom=ncf->molecule.get_atom(iatom);
+				distance_vec(xvals,atom,dx.data(),dy.data(),dz.data(),r.data(),npts);
+				ncf->Spp_div_S_vec(r.data(),atom.q,s.data(),npts);
+				for (int i=0; i<npts; ++i) fvals[i]+=s[i];
+			}
+		}
 		std::vector<coord_3d> special_points() const {
 			return ncf->molecule.get_all_coords_vec();
 		}
@@ -629,6 +723,14 @@ public:
             return ncf->Spp_div_S(r,atom.q);
         }
 
+        bool supports_vectorized() const {return true;}
+
+        void operator()(const Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+            std::vector<double> dx(npts), dy(npts), dz(npts), r(npts);
+            distance_vec(xvals,ncf->molecule.get_atom(iatom),dx.data(),dy.data(),dz.data(),r.data(),npts);
+            ncf->Spp_div_S_vec(r.data(),ncf->molecule.get_atom(iatom).q,fvals,npts);
+        }
+
         std::vector<coord_3d> special_points() const {
             std::vector< madness::Vector<double,3> > c(1);
             const Atom& atom=ncf->molecule.get_atom(iatom);
@@ -1018,6 +1120,22 @@ private:
         return num/denom;
     }
 
+	void S_vec(const double* r, const double Z, double* result, const long npt) const {
+		for (long i=0; i<npt; ++i) {
+			const double rho=r[i]*Z;
+			result[i]=exp(-rho)+(1.0-exp(-(rho*rho)));
+		}
+	}
+
+    void Sr_div_S_vec(const double* r, const double Z, double* result, const long npt) const {
+        for (long i=0; i<npt; ++i) {
+            const double Zr=r[i]*Z;
+            const double eA=exp(-Zr);
+            const double gA=exp(-Zr*Zr);
+            result[i]=Z*(2.0*Zr*gA-eA)/(1.0+eA-gA);
+        }
+    }
+
     double Srr_div_S(const double& r, const double& Z) const {
         const double Zr=r*Z;
         const double eA=exp(-Zr);
@@ -1393,6 +1511,17 @@ private:
 //    	         + exp(-a*r*Z + 0.5*a*Z*(4.0*r+a*eprec*Z)) * erfc((r+a*eprec*Z)/sqrt(2*eprec)));
     }
 
+    void S_vec(const double* r, const double Z, double* result, const long npt) const {
+        const double a=a_param();
+        const double fac=1.0/(a-1.0);
+        for (long i=0; i<npt; ++i) result[i]=1.0+fac*exp(-a*Z*r[i]);
+    }
+
+    void Sr_div_S_vec(const double* r, const double Z, double* result, const long npt) const {
+        const double a=a_param();
+        for (long i=0; i<npt; ++i) result[i]=-a*Z/(1.0+(a-1.0)*exp(a*r[i]*Z));
+    }
+
     /// radial part first derivative of the nuclear correlation factor
     coord_3d Sp(const coord_3d& vr1A, const double& Z) const {
     	const double a=a_param();
@@ -110,7 +110,7 @@ Exchange<T, NDIM>::ExchangeImpl::K_macrotask_efficient(const vecfuncT& vf, const
 
     // the result is a vector of functions living in the universe
     const long nresult = vf.size();
-    MacroTaskExchangeSimple xtask(nresult, lo, mul_tol, is_symmetric());
+    MacroTaskExchangeSimple xtask(nresult, lo, mul_tol, is_symmetric(), get_screening_tol());
     vecfuncT Kf;
 
     // deferred execution if a taskq is provided by the user
@@ -157,31 +157,102 @@ std::vector<Function<T, NDIM> > Exchange<T, NDIM>::ExchangeImpl::K_large_memory(
                                                                   const double mul_tol) const {    // Larger memory algorithm ... use i-j sym if psi==f
 
     auto poisson = set_poisson(world, lo);
-    vecfuncT result = compute_K_tile(world, mo_bra, mo_ket, vket, poisson, is_symmetric(), mul_tol);
+    vecfuncT result = compute_K_tile(world, mo_bra, mo_ket, vket, poisson, is_symmetric(), mul_tol,
+                                     get_screening_tol());
     truncate(world, result);
     return result;
 }
 
+/// upper bounds for the L1 norm of all pair products \int |f_i g_j|
+
+/// the screening level is chosen such that the boxes are about 4 bohr wide, which is roughly
+/// the extent of a localized orbital. The box norms of all functions are summed over all processes.
+template<typename T, std::size_t NDIM>
+Tensor<double> Exchange<T, NDIM>::ExchangeImpl::compute_pair_bounds(World& world, const vecfuncT& f, const vecfuncT& g) {
+
+    const double width = FunctionDefaults<NDIM>::get_cell_min_width();
+    const int level = std::max(1, std::min(5, int(std::log2(width / 4.0))));
+    const long nbox_1d = 1l << level;
+    long nbox = 1;
+    for (std::size_t d = 0; d < NDIM; ++d) nbox *= nbox_1d;
+
+    // norms of the functions in all boxes on the screening level
+    auto box_norms = [&](const vecfuncT& v) {
+        reconstruct(world, v, false);
+        world.gop.fence();
+        norm_tree(world, v);
+        Tensor<double> norms(v.size(), nbox);
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            const auto& coeffs = v[i].get_impl()->get_coeffs();
+            for (auto it = coeffs.begin(); it != coeffs.end(); ++it) {
+                const Key<NDIM>& key = it->first;
+                const auto& node = it->second;
+                const int n = key.level();
+                if (n > level) continue;
+                if (n < level and node.has_children()) continue;
+                const double norm = node.has_children() ? node.get_norm_tree() : node.coeff().normf();
+
+                // boxes on the screening level covered by this box
+                const long nsub = 1l << (level - n);
+                long nsubbox = 1;
+                for (std::size_t d = 0; d < NDIM; ++d) nsubbox *= nsub;
+                for (long isub = 0; isub < nsubbox; ++isub) {
+                    long index = 0;
+                    long remainder = isub;
+                    for (std::size_t d = 0; d < NDIM; ++d) {
+                        const long l = key.translation()[d] * nsub + remainder % nsub;
+                        remainder /= nsub;
+                        index = index * nbox_1d + l;
+                    }
+                    norms(i, index) = norm;
+                }
+            }
+        }
+        world.gop.sum(norms.ptr(), norms.size());
+        return norms;
+    };
+
+    Tensor<double> fnorms = box_norms(f);
+    Tensor<double> gnorms = (&f == &g) ? fnorms : box_norms(g);
+    return inner(fnorms, gnorms, 1, 1);
+}
+
 template<typename T, std::size_t NDIM>
 std::vector<Function<T, NDIM> >
 Exchange<T, NDIM>::ExchangeImpl::compute_K_tile(World& world, const vecfuncT& mo_bra, const vecfuncT& mo_ket,
                                   const vecfuncT& vket, std::shared_ptr<real_convolution_3d> poisson,
-                                  const bool symmetric, const double mul_tol) {
+                                  const bool symmetric, const double mul_tol, const double screen_tol) {
 
     double cpu0 = cpu_time();
     const long nf = vket.size();
     const long nocc = mo_ket.size();
     vecfuncT Kf = zero_functions_compressed<T, NDIM>(world, nf);
 
+    // skip pairs with a negligible product
+    Tensor<double> bounds;
+    if (screen_tol > 0.0) bounds = compute_pair_bounds(world, mo_bra, vket);
+
     vecfuncT psif;
+    std::vector<std::pair<int, int>> pairs;
+    long nskipped = 0;
     for (int i = 0; i < nocc; ++i) {
         int jtop = nf;
         if (symmetric)
             jtop = i + 1;
         for (int j = 0; j < jtop; ++j) {
+            if (screen_tol > 0.0 and bounds(i, j) < screen_tol) {
+                nskipped++;
+                continue;
+            }
+            pairs.push_back(std::make_pair(i, j));
             psif.push_back(mul_sparse(mo_bra[i], vket[j], mul_tol, false));
         }
     }
+    if (world.rank() == 0) {
+        npair_computed += pairs.size();
+        npair_skipped += nskipped;
+    }
+    if (pairs.size() == 0) return Kf;
 
     world.gop.fence();
     truncate(world, psif);
@@ -197,17 +268,15 @@ Exchange<T, NDIM>::ExchangeImpl::compute_K_tile(World& world, const vecfuncT& mo
     cpu0 = cpu_time();
     reconstruct(world, psif);
     norm_tree(world, psif);
-    vecfuncT psipsif = zero_functions<T, NDIM>(world, nf * nocc);
-    int ij = 0;
-    for (int i = 0; i < nocc; ++i) {
-        int jtop = nf;
-        if (symmetric)
-            jtop = i + 1;
-        for (int j = 0; j < jtop; ++j, ++ij) {
-            psipsif[i * nf + j] = mul_sparse(psif[ij], mo_ket[i], mul_tol, false);
-            if (symmetric && i != j) {
-                psipsif[j * nf + i] = mul_sparse(psif[ij], mo_ket[j], mul_tol, false);
-            }
+    vecfuncT psipsif;
+    std::vector<int> target;        // the result function psipsif[ij] is added to
+    for (std::size_t ij = 0; ij < pairs.size(); ++ij) {
+        const auto [i, j] = pairs[ij];
+        psipsif.push_back(mul_sparse(psif[ij], mo_ket[i], mul_tol, false));
+        target.push_back(j);
+        if (symmetric && i != j) {
+            psipsif.push_back(mul_sparse(psif[ij], mo_ket[j], mul_tol, false));
+            target.push_back(i);
         }
     }
 
@@ -217,10 +286,8 @@ Exchange<T, NDIM>::ExchangeImpl::compute_K_tile(World& world, const vecfuncT& mo
     psif.clear();
     world.gop.fence();
     compress(world, psipsif);
-    for (int i = 0; i < nocc; ++i) {
-        for (int j = 0; j < nf; ++j) {
-            Kf[j].gaxpy(1.0, psipsif[i * nf + j], 1.0, false);
-        }
+    for (std::size_t ij = 0; ij < psipsif.size(); ++ij) {
+        Kf[target[ij]].gaxpy(1.0, psipsif[ij], 1.0, false);
     }
     // !! NO TRUNCATION AT THIS POINT !!
     world.gop.fence();
@@ -244,29 +311,65 @@ Exchange<T, NDIM>::ExchangeImpl::MacroTaskExchangeSimple::compute_offdiagonal_ba
                                                                                           const vecfuncT& mo_ket,      // not batched
                                                                                           const vecfuncT& bra_batch,   // batched
                                                                                           const vecfuncT& vf_batch) const { // batched
+    // some helper functions
+    std::size_t nrow = bra_batch.size();
+    std::size_t ncolumn = vf_batch.size();
+    auto ij = [&ncolumn](const int i, const int j) { return i * ncolumn + j; };
+
     // orbital_product is a vector of vectors
     double cpu0 = cpu_time();
-    std::vector<vecfuncT> orbital_product = matrix_mul_sparse<T, T, NDIM>(subworld, bra_batch, vf_batch, mul_tol);
-    vecfuncT orbital_product_flat = flatten(orbital_product); // convert into a flattened vector
+    vecfuncT orbital_product_flat;
+    std::vector<bool> is_computed(nrow * ncolumn, true);      // false if the pair has been screened
+    if (screen_tol > 0.0) {
+        Tensor<double> bounds = compute_pair_bounds(subworld, bra_batch, vf_batch);
+        for (std::size_t i = 0; i < nrow; ++i) {
+            for (std::size_t j = 0; j < ncolumn; ++j) {
+                is_computed[ij(i, j)] = (bounds(i, j) >= screen_tol);
+                if (is_computed[ij(i, j)]) orbital_product_flat.push_back(mul_sparse(bra_batch[i], vf_batch[j], mul_tol, false));
+            }
+        }
+        subworld.gop.fence();
+    } else {
+        std::vector<vecfuncT> orbital_product = matrix_mul_sparse<T, T, NDIM>(subworld, bra_batch, vf_batch, mul_tol);
+        orbital_product_flat = flatten(orbital_product); // convert into a flattened vector
+    }
+    const long ncomputed = orbital_product_flat.size();
+    if (subworld.rank() == 0) {
+        npair_computed += ncomputed;
+        npair_skipped += nrow * ncolumn - ncomputed;
+    }
     truncate(subworld, orbital_product_flat);
     double cpu1 = cpu_time();
     mul1_timer += long((cpu1 - cpu0) * 1000l);
 
     cpu0 = cpu_time();
     auto poisson = set_poisson(subworld, lo);
-    vecfuncT Nij = apply(subworld, *poisson.get(), orbital_product_flat);
-    truncate(subworld, Nij);
+    vecfuncT Nij_computed = apply(subworld, *poisson.get(), orbital_product_flat);
+    truncate(subworld, Nij_computed);
     cpu1 = cpu_time();
     apply_timer += long((cpu1 - cpu0) * 1000l);
 
+    // screened pairs are represented by empty functions
+    vecfuncT Nij(nrow * ncolumn);
+    for (std::size_t i = 0, icomputed = 0; i < Nij.size(); ++i) {
+        if (is_computed[i]) Nij[i] = Nij_computed[icomputed++];
+    }
+
     // accumulate columns:      resultrow(i)=\sum_j j N_ij
     // accumulate rows:      resultcolumn(j)=\sum_i i N_ij
     cpu0 = cpu_time();
 
-    // some helper functions
-    std::size_t nrow = bra_batch.size();
-    std::size_t ncolumn = vf_batch.size();
-    auto ij = [&ncolumn](const int i, const int j) { return i * ncolumn + j; };
+    // dot product of the functions in v and the non-screened elements of the N-slice
+    auto dot_computed = [&subworld](const vecfuncT& v, const vecfuncT& Nslice) {
+        vecfuncT v1, N1;
+        for (std::size_t i = 0; i < Nslice.size(); ++i) {
+            if (not Nslice[i].is_initialized()) continue;
+            v1.push_back(v[i]);
+            N1.push_back(Nslice[i]);
+        }
+        if (N1.size() == 0) return zero_functions_compressed<T, NDIM>(subworld, 1).front();
+        return dot(subworld, v1, N1);
+    };
 
     auto Nslice = [&Nij, &ij, &ncolumn](const long irow, const Slice s) {
         vecfuncT result;
@@ -296,13 +399,13 @@ Exchange<T, NDIM>::ExchangeImpl::MacroTaskExchangeSimple::compute_offdiagonal_ba
 
     vecfuncT resultcolumn(nrow);
     for (std::size_t irow = 0; irow < nrow; ++irow) {
-        resultcolumn[irow] = dot(subworld, to_dot_with_vf,
-                                 Nslice(irow, _));  // sum over columns result=sum_j ket[j] N[j,i]
+        resultcolumn[irow] = dot_computed(to_dot_with_vf,
+                                          Nslice(irow, _));  // sum over columns result=sum_j ket[j] N[j,i]
     }
     vecfuncT resultrow(ncolumn);
     for (std::size_t icolumn = 0; icolumn < ncolumn; ++icolumn) {
-        resultrow[icolumn] = dot(subworld, to_dot_with_bra,
-                                 Nslice1(_, icolumn));  // sum over rows result=sum_i ket[i] N[j,i]
+        resultrow[icolumn] = dot_computed(to_dot_with_bra,
+                                          Nslice1(_, icolumn));  // sum over rows result=sum_i ket[i] N[j,i]
     }
 
     // !! NO TRUNCATION AT THIS POINT !!
@@ -21,11 +21,15 @@ class Exchange<T,NDIM>::ExchangeImpl {
     static inline std::atomic<long> apply_timer;
     static inline std::atomic<long> mul2_timer;
     static inline std::atomic<long> mul1_timer; ///< timing
+    static inline std::atomic<long> npair_computed;
+    static inline std::atomic<long> npair_skipped;     ///< pairs skipped by screening
 
     static void reset_timer() {
         mul1_timer = 0l;
         mul2_timer = 0l;
         apply_timer = 0l;
+        npair_computed = 0l;
+        npair_skipped = 0l;
     }
 
     static void print_timer(World& world) {
@@ -35,10 +39,12 @@ class Exchange<T,NDIM>::ExchangeImpl {
         world.gop.sum(t1);
         world.gop.sum(t2);
         world.gop.sum(t3);
+        auto [ncomputed, nskipped] = get_pair_statistics(world);
         if (world.rank() == 0) {
             printf(" cpu time spent in multiply1   %8.2fs\n", t1);
             printf(" cpu time spent in apply       %8.2fs\n", t2);
             printf(" cpu time spent in multiply2   %8.2fs\n", t3);
+            if (nskipped>0) printf(" orbital pairs computed/skipped %ld/%ld\n",ncomputed,nskipped);
         }
     }
 
@@ -100,6 +106,37 @@ public:
         return *this;
     }
 
+    /// skip orbital pairs whose product is bounded by less than factor*thresh; 0 disables screening
+
+    /// the bound is computed from the norms of the orbitals in coarse boxes, see compute_pair_bounds().
+    /// Localized orbitals of extended systems have few non-negligible pairs, so that the number
+    /// of Poisson applications grows about linearly with the system size.
+    ExchangeImpl& set_screening(const double factor) {
+        screening=factor;
+        return *this;
+    }
+
+    /// the tolerance for skipping orbital pairs
+    double get_screening_tol() const {return screening*thresh;}
+
+    /// upper bounds for the L1 norm of all pair products \int |f_i g_j|
+
+    /// the functions are represented by their L2 norms in the boxes of a coarse screening level,
+    /// coarser leaf boxes contribute their norm to all boxes they cover. The Cauchy-Schwarz inequality
+    /// in each box then yields \int |f_i g_j| <= \sum_b ||f_i||_b ||g_j||_b
+    /// @return a tensor of dimensions (f.size(), g.size())
+    static Tensor<double> compute_pair_bounds(World& world, const vecfuncT& f, const vecfuncT& g);
+
+    /// number of orbital pairs computed and skipped by screening in the last call
+
+    /// the pairs are counted by rank 0 of the world or subworld that computed them,
+    /// so this is a collective operation summing the counts over the universe
+    static std::pair<long,long> get_pair_statistics(World& universe) {
+        long npair[2] = {long(npair_computed), long(npair_skipped)};
+        universe.gop.sum(npair, 2);
+        return std::make_pair(npair[0], npair[1]);
+    }
+
 private:
 
     /// exchange using macrotasks, i.e. apply K on a function in individual worlds
@@ -114,7 +151,8 @@ private:
     /// computing the upper triangle of the double sum (over vket and the K orbitals)
     static vecfuncT compute_K_tile(World& world, const vecfuncT& mo_bra, const vecfuncT& mo_ket,
                                    const vecfuncT& vket, std::shared_ptr<real_convolution_3d> poisson,
-                                   const bool symmetric, const double mul_tol = 0.0);
+                                   const bool symmetric, const double mul_tol = 0.0,
+                                   const double screen_tol = 0.0);
 
     inline bool do_print_timings() const { return (world.rank() == 0) and (printlevel >= 3); }
 
@@ -128,6 +166,7 @@ private:
     double thresh = FunctionDefaults<NDIM>::get_thresh();
     long printlevel = 0;
     double mul_tol = 0.0;
+    double screening = 0.0;     ///< skip pairs with product bound below screening*thresh
 
     class MacroTaskExchangeSimple : public MacroTaskOperationBase {
 
@@ -135,6 +174,7 @@ private:
         double lo = 1.e-4;
         double mul_tol = 1.e-7;
         bool symmetric = false;
+        double screen_tol = 0.0;
 
         /// custom partitioning for the exchange operator in exchangeoperator.h
 
@@ -184,8 +224,9 @@ private:
         };
 
     public:
-        MacroTaskExchangeSimple(const long nresult, const double lo, const double mul_tol, const bool symmetric)
-                : nresult(nresult), lo(lo), mul_tol(mul_tol), symmetric(symmetric) {
+        MacroTaskExchangeSimple(const long nresult, const double lo, const double mul_tol, const bool symmetric,
+                                const double screen_tol=0.0)
+                : nresult(nresult), lo(lo), mul_tol(mul_tol), symmetric(symmetric), screen_tol(screen_tol) {
             partitioner.reset(new MacroTaskPartitionerExchange(symmetric));
         }
 
@@ -264,7 +305,7 @@ private:
             double symmetric = true;
             auto poisson = Exchange<double, 3>::ExchangeImpl::set_poisson(subworld, lo);
             return Exchange<T, NDIM>::ExchangeImpl::compute_K_tile(subworld, bra_batch, ket_batch, vf_batch, poisson, symmetric,
-                                                     mul_tol);
+                                                     mul_tol, screen_tol);
         }
 
         /// compute a batch of the exchange matrix, with non-identical ranges
@@ -282,7 +323,7 @@ private:
             double symmetric = false;
             auto poisson = Exchange<double, 3>::ExchangeImpl::set_poisson(subworld, lo);
             return Exchange<T, NDIM>::ExchangeImpl::compute_K_tile(subworld, bra_batch, ket_batch, vf_batch, poisson, symmetric,
-                                                     mul_tol);
+                                                     mul_tol, screen_tol);
         }
 
         /// compute a batch of the exchange matrix, with non-identical ranges
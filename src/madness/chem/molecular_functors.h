@@ -41,6 +41,17 @@ public:
         return aofunc(x[0], x[1], x[2]);
     }
 
+    bool supports_vectorized() const {return true;}
+
+    void operator()(const madness::Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+        aofunc(xvals[0], xvals[1], xvals[2], fvals, npts);
+    }
+
+    /// the function is zero in boxes lying entirely outside its range
+    bool screened(const madness::coord_3d& c1, const madness::coord_3d& c2) const {
+        return aofunc.is_outside_range(c1, c2);
+    }
+
     std::vector<madness::coord_3d> special_points() const {
         return std::vector<madness::coord_3d>(1,aofunc.get_coords_vec());
     }
@@ -64,6 +75,12 @@ public:
                *molecule.get_rcut()[iatom];
     }
 
+    bool supports_vectorized() const {return true;}
+
+    void operator()(const madness::Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+        molecule.atomic_attraction_potential(iatom, xvals[0], xvals[1], xvals[2], fvals, npts);
+    }
+
     std::vector<madness::coord_3d> special_points() const {
         return std::vector<madness::coord_3d>(1,molecule.get_atom(iatom).get_coords());
     }
@@ -84,6 +101,14 @@ public:
         return molecule.nuclear_attraction_potential_derivative(atom, axis, x[0], x[1], x[2]);
     }
 
+    bool supports_vectorized() const {return true;}
+
+    void operator()(const madness::Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+        for (int i=0; i<npts; ++i)
+            fvals[i]=molecule.nuclear_attraction_potential_derivative(atom, axis,
+                    xvals[0][i], xvals[1][i], xvals[2][i]);
+    }
+
     std::vector<madness::coord_3d> special_points() const {
         return std::vector<madness::coord_3d>(1,molecule.get_atom(atom).get_coords());
     }
@@ -106,6 +131,14 @@ public:
                                                                        iaxis, jaxis, x[0], x[1], x[2]);
     }
 
+    bool supports_vectorized() const {return true;}
+
+    void operator()(const madness::Vector<double*,3>& xvals, double* MADNESS_RESTRICT fvals, int npts) const {
+        for (int i=0; i<npts; ++i)
+            fvals[i]=molecule.nuclear_attraction_potential_second_derivative(atom, iaxis, jaxis,
+                    xvals[0][i], xvals[1][i], xvals[2][i]);
+    }
+
     std::vector<madness::coord_3d> special_points() const {
         return std::vector<madness::coord_3d>(1,molecule.get_atom(atom).get_coords());
     }
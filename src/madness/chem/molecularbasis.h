@@ -117,6 +117,25 @@ public:
     }
 
 
+    /// Evaluates the radial part of the contracted function at npt points
+
+    /// Same screening as the scalar version, with the primitives in the
+    /// outer loop so the inner loop over points vectorizes.
+    void eval_radial(const double* rsq, double* R, long npt) const {
+        for (long i=0; i<npt; ++i) R[i] = 0.0;
+        for (unsigned int p=0; p<coeff.size(); ++p) {
+            const double c = coeff[p], e = expnt[p];
+            for (long i=0; i<npt; ++i) {
+                const double ersq = e*rsq[i];
+                R[i] += (ersq < 27.6) ? c*exp(-ersq) : 0.0;
+            }
+        }
+        for (long i=0; i<npt; ++i) {
+            if (rsq[i] > rsqmax || fabs(R[i]) < 1e-12) R[i] = 0.0;
+        }
+    }
+
+
     /// Evaluates the entire shell returning the incremented result pointer
     double* eval(double rsq, double x, double y, double z, double* bf) const {
         double R = eval_radial(rsq);
@@ -433,6 +452,44 @@ public:
         return bf[ibf];
     }
 
+    /// Evaluates the function at npt points given by separate coordinate arrays
+    void operator()(const double* x, const double* y, const double* z,
+                    double* result, long npt) const {
+        // powers of x, y, z in the same order as ContractedGaussianShell::eval
+        const int type = shell.angular_momentum();
+        int lx=type, ly=0, n=ibf;
+        for (; lx>=0; --lx) {
+            if (n <= type-lx) break;
+            n -= type-lx+1;
+        }
+        ly = type-lx-n;
+        const int lz = type-lx-ly;
+
+        std::vector<double> dx(npt), dy(npt), dz(npt), rsq(npt);
+        for (long i=0; i<npt; ++i) {
+            dx[i] = x[i]-xx;
+            dy[i] = y[i]-yy;
+            dz[i] = z[i]-zz;
+            rsq[i] = dx[i]*dx[i] + dy[i]*dy[i] + dz[i]*dz[i];
+        }
+        shell.eval_radial(rsq.data(), result, npt);
+        for (int l=0; l<lx; ++l) for (long i=0; i<npt; ++i) result[i] *= dx[i];
+        for (int l=0; l<ly; ++l) for (long i=0; i<npt; ++i) result[i] *= dy[i];
+        for (int l=0; l<lz; ++l) for (long i=0; i<npt; ++i) result[i] *= dz[i];
+    }
+
+    /// True if the box [lo,hi] lies entirely beyond the range of the function
+    bool is_outside_range(const madness::Vector<double,3>& lo,
+                          const madness::Vector<double,3>& hi) const {
+        const double c[3] = {xx, yy, zz};
+        double rsq = 0.0;
+        for (int d=0; d<3; ++d) {
+            const double dist = std::max(0.0, std::max(lo[d]-c[d], c[d]-hi[d]));
+            rsq += dist*dist;
+        }
+        return rsq > rangesq();
+    }
+
     void print_me(std::ostream& s) const;
 
     const ContractedGaussianShell& get_shell() const {
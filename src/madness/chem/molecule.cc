@@ -1005,6 +1005,42 @@ double Molecule::atomic_attraction_potential(int iatom, double x, double y,
 }
 
 
+/// adds the potential of the smoothed point charge q at atom to result at npt points
+static void add_smoothed_attraction(const Atom& atom, const double rc, const double* x,
+        const double* y, const double* z, double* result, long npt) {
+    std::vector<double> rr(npt), v(npt);
+    for (long i=0; i<npt; ++i) {
+        const double dx=x[i]-atom.x, dy=y[i]-atom.y, dz=z[i]-atom.z;
+        rr[i] = sqrt(dx*dx + dy*dy + dz*dz)*rc;
+        v[i] = 1.0/rr[i];
+    }
+    // smoothed_potential is exactly 1/r beyond 7
+    for (long i=0; i<npt; ++i) {
+        if (rr[i] <= 7.0) v[i] = smoothed_potential(rr[i]);
+    }
+    const double qrc = atom.q*rc;
+    for (long i=0; i<npt; ++i) result[i] -= qrc*v[i];
+}
+
+void Molecule::nuclear_attraction_potential(const double* x, const double* y,
+        const double* z, double* result, long npt) const {
+    for (long i=0; i<npt; ++i) {
+        result[i] = field[0] * x[i] + field[1] * y[i] + field[2] * z[i];
+    }
+    for (unsigned int i=0; i<atoms.size(); ++i) {
+        if (atoms[i].pseudo_atom) continue;
+        add_smoothed_attraction(atoms[i], rcut[i], x, y, z, result, npt);
+    }
+}
+
+void Molecule::atomic_attraction_potential(int iatom, const double* x, const double* y,
+        const double* z, double* result, long npt) const {
+    for (long i=0; i<npt; ++i) result[i] = 0.0;
+    if (atoms[iatom].pseudo_atom) return;
+    add_smoothed_attraction(atoms[iatom], rcut[iatom], x, y, z, result, npt);
+}
+
+
 double Molecule::nuclear_attraction_potential_derivative(int atom, int axis, double x, double y, double z) const {
     double r = distance(atoms[atom].x, atoms[atom].y, atoms[atom].z, x, y, z);
     double rc = rcut[atom];
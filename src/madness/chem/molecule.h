@@ -508,6 +508,14 @@ public:
     /// nuclear attraction potential for a specific atom in the molecule
     double atomic_attraction_potential(int iatom, double x, double y, double z) const;
 
+    /// nuclear attraction potential for the whole molecule at npt points
+    void nuclear_attraction_potential(const double* x, const double* y, const double* z,
+            double* result, long npt) const;
+
+    /// nuclear attraction potential for a specific atom at npt points
+    void atomic_attraction_potential(int iatom, const double* x, const double* y,
+            const double* z, double* result, long npt) const;
+
     double molecular_core_potential(double x, double y, double z) const;
 
     double core_potential_derivative(int atom, int axis, double x, double y, double z) const;
@@ -182,10 +182,18 @@ double Nemo::value(const Tensor<double>& x) {
 
 	    calc->ao=calc->project_ao_basis(world,calc->aobasis);
 
-		calc->initial_guess(world);
-		real_function_3d R_inverse = ncf->inverse();
-		calc->amo = R_inverse*calc->amo;
-		truncate(world,calc->amo);
+	    // warm start from the previous geometries if available
+	    if (nemo_history.size()>0) {
+	        if (world.rank()==0 and param.print_level()>2)
+	            print("extrapolating the nemos from",nemo_history.size(),"previous geometries");
+	        calc->amo=extrapolate_nemos();
+	    } else {
+	        calc->initial_guess(world);
+	        real_function_3d R_inverse = ncf->inverse();
+	        calc->amo = R_inverse*calc->amo;
+	        truncate(world,calc->amo);
+	    }
+	    calc->converged_for_thresh=1.e10;	// the guess is not converged at this geometry
 
 	}
 
@@ -208,6 +216,12 @@ double Nemo::value(const Tensor<double>& x) {
     }
 
 
+    // remember the converged nemos for extrapolating the next geometry
+    if (param.extrapolation_order()>0 and param.spin_restricted()) {
+        nemo_history.insert(nemo_history.begin(),copy(world,calc->amo));
+        if (nemo_history.size()>std::size_t(param.extrapolation_order())) nemo_history.pop_back();
+    }
+
     // save the converged orbitals and nemos
     for (std::size_t imo = 0; imo < calc->amo.size(); ++imo) {
         save(calc->amo[imo], "nemo" + stringify(imo));
@@ -229,6 +243,49 @@ double Nemo::value(const Tensor<double>& x) {
 }
 
 
+vecfuncT Nemo::extrapolate_nemos() const {
+    const std::size_t nmo=nemo_history.front().size();
+
+    // use only sets with the same number of orbitals as the most recent one
+    std::size_t nset=0;
+    while (nset<nemo_history.size() and nemo_history[nset].size()==nmo) ++nset;
+
+    // the nemos are determined only up to a unitary transformation; rotate
+    // the older sets onto the most recent one (orthogonal Procrustes):
+    // S = <old | new> = W sigma VT  ->  U = W VT
+    const vecfuncT Rnew=R*nemo_history.front();
+    std::vector<vecfuncT> aligned(1,nemo_history.front());
+    for (std::size_t iset=1; iset<nset; ++iset) {
+        Tensor<double> S=matrix_inner(world,R*nemo_history[iset],Rnew);
+        Tensor<double> W, sigma, VT;
+        svd(S,W,sigma,VT);
+        aligned.push_back(transform(world,nemo_history[iset],inner(W,VT)));
+    }
+
+    // always-stable predictor-corrector coefficients for K=nset-1:
+    // B_j = (-1)^(j+1) j binom(2K+2,K+1-j) / binom(2K,K)
+    auto binomial=[](const long n, const long k) {
+        double b=1.0;
+        for (long i=1; i<=k; ++i) b=b*(n-k+i)/i;
+        return b;
+    };
+    const long K=nset-1;
+    vecfuncT result=zero_functions_compressed<double,3>(world,nmo);
+    for (long j=1; j<=K+1; ++j) {
+        const double B=((j%2==1) ? 1.0 : -1.0)*j*binomial(2*K+2,K+1-j)/binomial(2*K,K);
+        if (world.rank()==0 and param.print_level()>2) print("extrapolation coefficient",j,B);
+        compress(world,aligned[j-1]);
+        gaxpy(world,1.0,result,B,aligned[j-1]);
+    }
+
+    // the nemos are free of the nuclear cusps, so the trees of the previous
+    // geometries need no refinement at the moved nuclei beyond what the SCF
+    // iterations adapt anyway
+    truncate(world,result);
+    orthonormalize(result,R);
+    return result;
+}
+
 /// localize the nemo orbitals according to Pipek-Mezey or Foster-Boys
 vecfuncT Nemo::localize(const vecfuncT& nemo, const double dconv, const bool randomize) const {
 
@@ -1117,7 +1174,7 @@ vecfuncT Nemo::make_cphf_constant_term(const size_t iatom, const int iaxis,
     // linear in the density
     vecfuncT Kconstnemo=zero_functions_compressed<double,3>(world,nmo);
     if (not is_dft()) {
-        Exchange<double,3> Kconst(world,param.lo());
+        Exchange<double,3> Kconst=make_cphf_exchange(world);
         vecfuncT kbra=2.0*RXR*nemo;
         truncate(world,kbra);
         Kconst.set_bra_and_ket(kbra, nemo);
@@ -1142,15 +1199,25 @@ vecfuncT Nemo::solve_cphf(const size_t iatom, const int iaxis, const Tensor<doub
         const vecfuncT& guess, const vecfuncT& rhsconst,
         const Tensor<double> incomplete_hessian, const vecfuncT& parallel,
         const SCFProtocol& proto, const std::string& xc_data) const {
+    return solve_cphf(world,ncf,R_square,calc->amo,iatom,iaxis,fock,guess,rhsconst,
+            incomplete_hessian,parallel,proto.dconv,xc_data);
+}
+
+
+vecfuncT Nemo::solve_cphf(World& world, std::shared_ptr<NuclearCorrelationFactor> ncf,
+        const real_function_3d& R_square, const vecfuncT& nemo,
+        const size_t iatom, const int iaxis, const Tensor<double> fock,
+        const vecfuncT& guess, const vecfuncT& rhsconst,
+        const Tensor<double> incomplete_hessian, const vecfuncT& parallel,
+        const double dconv, const std::string& xc_data) const {
 
     print("\nsolving nemo cphf equations for atom, axis",iatom,iaxis);
 
     vecfuncT xi=guess;
     // guess for the perturbed MOs
-    const vecfuncT nemo=calc->amo;
     const int nmo=nemo.size();
     const Tensor<double> occ=get_calc()->get_aocc();
-    const real_function_3d rhonemo=2.0*make_density(occ,nemo); // closed shell
+    const real_function_3d rhonemo=2.0*get_calc()->make_density(world,occ,nemo); // closed shell
     const real_function_3d arho=0.5*R_square*rhonemo;
     NuclearCorrelationFactor::RX_functor rxr_func(ncf.get(),iatom,iaxis,2);
     const real_function_3d RXR=real_factory_3d(world).functor(rxr_func).truncate_on_project();
@@ -1181,11 +1248,13 @@ vecfuncT Nemo::solve_cphf(const size_t iatom, const int iaxis, const Tensor<doub
     solverT solver(allocT(world, nemo.size()));
     solver.set_maxsub(5);
 
-    // construct unperturbed operators
-    const Coulomb<double,3> J(world,this);
-    const Exchange<double,3> K=Exchange<double,3>(world,this,0);
+    // construct unperturbed operators from the quantities living in world
+    Coulomb<double,3> J(world,calc->param.lo(),calc->param.econv());
+    J.potential()=J.compute_potential((R_square*rhonemo).truncate());
+    Exchange<double,3> K=make_cphf_exchange(world);
+    K.set_bra_and_ket(R2nemo,nemo);
     const XCOperator<double,3> xc(world, xc_data, not param.spin_restricted(), arho, arho);
-    const Nuclear<double,3> V(world,this);
+    const Nuclear<double,3> V(world,ncf);
 
     Tensor<double> h_diff(3l);
     for (int iter=0; iter<10; ++iter) {
@@ -1207,7 +1276,7 @@ vecfuncT Nemo::solve_cphf(const size_t iatom, const int iaxis, const Tensor<doub
         const vecfuncT xi_complete=xi-parallel;
 
         // factor 4 from: closed shell (2) and cphf (2)
-        real_function_3d density_pert=4.0*make_density(occ,R2nemo,xi_complete);
+        real_function_3d density_pert=4.0*dot(world,R2nemo,xi_complete);
         Jp.potential()=Jp.compute_potential(density_pert);
         vecfuncT Kp;
         if (is_dft()) {
@@ -1216,11 +1285,11 @@ vecfuncT Nemo::solve_cphf(const size_t iatom, const int iaxis, const Tensor<doub
             real_function_3d gamma=-1.0*xc.apply_xc_kernel(full_dens_pt);
             Kp=truncate(gamma*nemo);
         } else {
-            Exchange<double,3> Kp1(world,param.lo());
+            Exchange<double,3> Kp1=make_cphf_exchange(world);
             Kp1.set_bra_and_ket(R2nemo, xi_complete).set_symmetric(true);
             vecfuncT R2xi=mul(world,R_square,xi_complete);
             truncate(world,R2xi);
-            Exchange<double,3> Kp2(world,param.lo());
+            Exchange<double,3> Kp2=make_cphf_exchange(world);
             Kp2.set_bra_and_ket(R2xi, nemo);
             Kp=truncate(Kp1(nemo) + Kp2(nemo));
         }
@@ -1285,13 +1354,99 @@ vecfuncT Nemo::solve_cphf(const size_t iatom, const int iaxis, const Tensor<doub
         print(h+ihr);
         old_h=h;
 
-        if (rms/norm<proto.dconv and (h_diff.absmax()<1.e-2)) break;
+        if (rms/norm<dconv and (h_diff.absmax()<1.e-2)) break;
     }
     return xi;
 
 }
 
 
+Exchange<double,3> Nemo::make_cphf_exchange(World& world) const {
+    Exchange<double,3> K(world,param.lo());
+    K.set_printlevel(param.print_level()).set_screening(param.hfexscreen());
+    const bool in_subworld=(world.id()!=this->world.id());
+    if (param.hfexalg()=="smallmem") {
+        K.set_algorithm(Exchange<double,3>::Algorithm::small_memory);
+    } else if ((param.hfexalg()=="largemem") or in_subworld) {
+        K.set_algorithm(Exchange<double,3>::Algorithm::large_memory);
+    } else {
+        K.set_algorithm(Exchange<double,3>::Algorithm::multiworld_efficient);
+    }
+    return K;
+}
+
+
+Nemo::MacroTaskCPHF::resultT Nemo::MacroTaskCPHF::operator()(const vecfuncT& xi,
+        const vecfuncT& rhsconst, const vecfuncT& parallel, const vecfuncT& mo,
+        const Tensor<double>& fock, const Tensor<double>& incomplete_hessian) const {
+
+    World& subworld=mo.front().world();
+    const long nmo=mo.size();
+    const long i=batch.input[0].begin/nmo;
+    MADNESS_CHECK(long(xi.size())==nmo);
+
+    const vecfuncT rhsconst_i(rhsconst.begin()+i*nmo,rhsconst.begin()+(i+1)*nmo);
+    const vecfuncT parallel_i(parallel.begin()+i*nmo,parallel.begin()+(i+1)*nmo);
+
+    // the nuclear correlation factor and its potentials must live in the subworld
+    const Molecule& molecule=nemo->molecule();
+    auto pm=std::make_shared<PotentialManager>(molecule,molecule.parameters.core_type());
+    if (not molecule.parameters.psp_calc()) pm->make_nuclear_potential(subworld);
+    auto ncf=create_nuclear_correlation_factor(subworld,molecule,pm,nemo->param.ncf());
+    ncf->initialize(FunctionDefaults<3>::get_thresh());
+    real_function_3d R_square=ncf->square();
+    R_square.set_thresh(FunctionDefaults<3>::get_thresh());
+
+    return nemo->solve_cphf(subworld,ncf,R_square,mo,i/3,i%3,fock,xi,rhsconst_i,
+            incomplete_hessian,parallel_i,dconv,xc_data);
+}
+
+
+std::vector<vecfuncT> Nemo::solve_all_cphf(const Tensor<double> fock,
+        const std::vector<vecfuncT>& guess, const std::vector<vecfuncT>& rhsconst,
+        const Tensor<double> incomplete_hessian, const std::vector<vecfuncT>& parallel,
+        const SCFProtocol& p, const std::string& xc_data) const {
+
+    const vecfuncT& nemo=calc->amo;
+    const long nmo=nemo.size();
+    const long npert=guess.size();
+
+    if (not param.cphf_subworlds()) {
+        std::vector<vecfuncT> xi(npert);
+        for (long i=0; i<npert; ++i) {
+            xi[i]=solve_cphf(i/3,i%3,fock,guess[i],rhsconst[i],incomplete_hessian,parallel[i],p,xc_data);
+        }
+        return xi;
+    }
+
+    // concatenate all displacements into one vector, nmo functions each
+    vecfuncT xi_all, rhsconst_all, parallel_all;
+    for (long i=0; i<npert; ++i) {
+        MADNESS_CHECK(long(guess[i].size())==nmo);
+        xi_all.insert(xi_all.end(),guess[i].begin(),guess[i].end());
+        rhsconst_all.insert(rhsconst_all.end(),rhsconst[i].begin(),rhsconst[i].end());
+        parallel_all.insert(parallel_all.end(),parallel[i].begin(),parallel[i].end());
+    }
+
+    const long nsubworld=std::max(1l,std::min(long(world.size()),npert));
+    auto taskq=std::shared_ptr<MacroTaskQ>(new MacroTaskQ(world,nsubworld));
+    taskq->set_printlevel(param.print_level());
+
+    MacroTaskCPHF t(this,p.dconv,xc_data,nmo);
+    MacroTask task(world,t,taskq);
+    vecfuncT result=task(xi_all,rhsconst_all,parallel_all,nemo,fock,incomplete_hessian);
+    if (param.print_level()>9) taskq->print_taskq();
+    taskq->run_all();
+
+    std::vector<vecfuncT> xi(npert);
+    for (long i=0; i<npert; ++i) {
+        xi[i]=vecfuncT(result.begin()+i*nmo,result.begin()+(i+1)*nmo);
+        truncate(world,xi[i]);
+    }
+    return xi;
+}
+
+
 std::vector<vecfuncT> Nemo::compute_all_cphf() {
 
     const int natom=molecule().natom();
@@ -1375,17 +1530,12 @@ std::vector<vecfuncT> Nemo::compute_all_cphf() {
             printf("\nstarting initial CPHF equations at time %8.1fs \n",wall_time());
         }
 
-        // double loop over all nuclear displacements
-        for (int i=0, iatom=0; iatom<natom; ++iatom) {
-            for (int iaxis=0; iaxis<3; ++iaxis, ++i) {
-                if (xi[i].size()>0) {
-                    for (real_function_3d& xij : xi[i]) xij.set_thresh(preiterations.current_prec);
-                }
-                xi[i]=solve_cphf(iatom,iaxis,fock,xi[i],rhsconst[i],
-                        incomplete_hessian,parallel[i],preiterations,"LDA");
-                save_function(xi[i],"xi_guess"+stringify(i));
-            }
+        // all nuclear displacements are solved concurrently in subworlds
+        for (int i=0; i<3*natom; ++i) {
+            for (real_function_3d& xij : xi[i]) xij.set_thresh(preiterations.current_prec);
         }
+        xi=solve_all_cphf(fock,xi,rhsconst,incomplete_hessian,parallel,preiterations,"LDA");
+        for (int i=0; i<3*natom; ++i) save_function(xi[i],"xi_guess"+stringify(i));
         if (world.rank()==0) {
             printf("\nfinished CPHF equations at time %8.1fs \n",wall_time());
         }
@@ -1411,17 +1561,12 @@ std::vector<vecfuncT> Nemo::compute_all_cphf() {
             print("solving CPHF with the density functional",param.xc());
         }
 
-        // double loop over all nuclear displacements
-        for (int i=0, iatom=0; iatom<natom; ++iatom) {
-            for (int iaxis=0; iaxis<3; ++iaxis, ++i) {
-                if (xi[i].size()>0) {
-                    for (real_function_3d& xij : xi[i]) xij.set_thresh(p.current_prec);
-                }
-                xi[i]=solve_cphf(iatom,iaxis,fock,xi[i],rhsconst[i],
-                        incomplete_hessian,parallel[i],p,param.xc());
-                save_function(xi[i],"xi_guess"+stringify(i));
-            }
+        // all nuclear displacements are solved concurrently in subworlds
+        for (int i=0; i<3*natom; ++i) {
+            for (real_function_3d& xij : xi[i]) xij.set_thresh(p.current_prec);
         }
+        xi=solve_all_cphf(fock,xi,rhsconst,incomplete_hessian,parallel,p,param.xc());
+        for (int i=0; i<3*natom; ++i) save_function(xi[i],"xi_guess"+stringify(i));
         if (world.rank()==0) {
             printf("\nfinished CPHF equations at time %8.1fs \n",wall_time());
         }
@@ -59,6 +59,7 @@
 #include"madness/mra/commandlineparser.h"
 #include<madness/chem/QCPropertyInterface.h>
 #include <madness/world/timing_utilities.h>
+#include <madness/mra/macrotaskq.h>
 
 namespace madness {
 
@@ -350,11 +351,15 @@ public:
 			initialize<bool> ("read_cphf",false,"read the converged orbital response for nuclear displacements from file");
 			initialize<bool> ("restart_cphf",false,"read the guess orbital response for nuclear displacements from file");
 			initialize<bool> ("purify_hessian",false,"symmetrize the hessian matrix based on atomic charges");
+			initialize<int> ("extrapolation_order",2,"number of previous geometries used to extrapolate the guess orbitals, 0: fresh guess");
+			initialize<bool> ("cphf_subworlds",true,"solve the CPHF equations of all nuclear displacements concurrently in subworlds");
             set_derived_value("k",7);
 		}
 
 		std::pair<std::string,double> ncf() const {return get<std::pair<std::string,double> >("ncf");}
 		bool hessian() const {return get<bool>("hessian");}
+		int extrapolation_order() const {return get<int>("extrapolation_order");}
+		bool cphf_subworlds() const {return get<bool>("cphf_subworlds");}
 
 	};
 
@@ -443,6 +448,74 @@ public:
 	        const Tensor<double> incomplete_hessian, const vecfuncT& parallel,
 	        const SCFProtocol& p, const std::string& xc_data) const;
 
+	/// solve the CPHF equations for the nuclear displacements in a given world
+
+	/// all world-bound quantities are passed in explicitly, so this can be
+	/// run in a subworld with the ground-state orbitals copied into it
+	/// @param[in]  world   the world all functions live in
+	/// @param[in]  ncf     the nuclear correlation factor living in world
+	/// @param[in]  R_square    the square of the nuclear correlation factor
+	/// @param[in]  nemo    the ground-state nemos
+	/// @param[in]  dconv   the convergence threshold for the residual
+	vecfuncT solve_cphf(World& world, std::shared_ptr<NuclearCorrelationFactor> ncf,
+	        const real_function_3d& R_square, const vecfuncT& nemo,
+	        const size_t iatom, const int iaxis, const Tensor<double> fock,
+	        const vecfuncT& guess, const vecfuncT& rhsconst,
+	        const Tensor<double> incomplete_hessian, const vecfuncT& parallel,
+	        const double dconv, const std::string& xc_data) const;
+
+	/// exchange operator for the CPHF equations in a given world
+
+	/// uses the exchange settings of the calculation; in a subworld of a
+	/// MacroTaskQ the multiworld algorithm would nest another task queue,
+	/// so the large-memory algorithm is used there instead
+	Exchange<double,3> make_cphf_exchange(World& world) const;
+
+	/// solve the CPHF equations for all displacements concurrently in subworlds
+
+	/// the perturbations are independent of each other, each one is solved
+	/// by a macrotask in its own subworld, sharing the ground-state orbitals
+	/// through the cloud. With cphf_subworlds=false they are solved one after
+	/// another in the universe.
+	/// @return the orbital response \ket{F^\perp} for all displacements
+	std::vector<vecfuncT> solve_all_cphf(const Tensor<double> fock,
+	        const std::vector<vecfuncT>& guess, const std::vector<vecfuncT>& rhsconst,
+	        const Tensor<double> incomplete_hessian, const std::vector<vecfuncT>& parallel,
+	        const SCFProtocol& p, const std::string& xc_data) const;
+
+	/// macrotask solving the CPHF equations for one nuclear displacement
+
+	/// the responses of all displacements are concatenated into a single
+	/// vector, which is partitioned into batches of nmo functions, i.e.
+	/// one batch per displacement
+	class MacroTaskCPHF : public MacroTaskOperationBase {
+	    const Nemo* nemo;
+	    double dconv;
+	    std::string xc_data;
+	public:
+	    typedef std::vector<real_function_3d> resultT;
+
+	    typedef std::tuple<const vecfuncT&, const vecfuncT&, const vecfuncT&,
+	            const vecfuncT&, const Tensor<double>&, const Tensor<double>&> argtupleT;
+
+	    MacroTaskCPHF(const Nemo* nemo, const double dconv, const std::string& xc_data,
+	            const long nmo) : nemo(nemo), dconv(dconv), xc_data(xc_data) {
+	        partitioner->set_min_batch_size(nmo).set_max_batch_size(nmo);
+	    }
+
+	    resultT allocator(World& world, const argtupleT& argtuple) const {
+	        return zero_functions_compressed<double,3>(world,std::get<0>(argtuple).size());
+	    }
+
+	    /// @param[in]  xi      the guess for the response of this batch's displacement
+	    /// @param[in]  rhsconst    the constant terms of all displacements
+	    /// @param[in]  parallel    the parallel terms of all displacements
+	    /// @param[in]  mo      the ground-state nemos
+	    resultT operator()(const vecfuncT& xi, const vecfuncT& rhsconst,
+	            const vecfuncT& parallel, const vecfuncT& mo, const Tensor<double>& fock,
+	            const Tensor<double>& incomplete_hessian) const;
+	};
+
 	/// solve the CPHF equation for all displacements
 
 	/// this function computes the nemo response F^X
@@ -585,6 +658,16 @@ private:
 	/// sum of square of coords at last solved geometry
 	mutable double coords_sum;
 
+	/// converged nemos at the previous geometries, most recent first
+	std::vector<vecfuncT> nemo_history;
+
+	/// guess for the nemos at the current geometry from the nemo history
+
+	/// the older nemo sets are rotated onto the most recent one, then the sets
+	/// are combined with the always-stable predictor-corrector coefficients
+	/// of Kolafa, J. Comput. Chem. 25, 335 (2004)
+	vecfuncT extrapolate_nemos() const;
+
 protected:
 	/// a poisson solver
 	std::shared_ptr<real_convolution_3d> poisson;
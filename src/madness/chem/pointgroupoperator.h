@@ -46,6 +46,7 @@
 #define SRC_APPS_CHEM_POINTGROUPOPERATOR_H_
 
 #include <madness/tensor/vector_factory.h>
+#include <madness/world/vector.h>
 
 namespace madness {
 
@@ -86,6 +87,24 @@ public:
 		return result;
 	}
 
+	/// apply the operator on a point in a cell that is symmetric about the origin
+
+	/// consistent with map_and_mirror: first map the dimensions, then mirror
+	template<std::size_t NDIM>
+	Vector<double,NDIM> operator()(const Vector<double,NDIM>& x) const {
+		if (name_=="identity") return x;
+		if (name_=="inversion") return -1.0*x;
+
+		Vector<double,NDIM> result=x;
+		if (mapdim_.size()>0) {
+			for (std::size_t i=0; i<NDIM; ++i) result[mapdim_[i]]=x[i];
+		}
+		if (mirrormap.size()>0) {
+			for (std::size_t i=0; i<NDIM; ++i) if (mirrormap[i]==-1) result[i]=-result[i];
+		}
+		return result;
+	}
+
 	/// apply the operator on an n-dimensional MRA function
 	template<typename T, std::size_t NDIM>
 	std::vector<Function<T,NDIM> > operator()(const std::vector<Function<T,NDIM> >& vf, bool fence=true) const {
@@ -491,7 +491,98 @@ charactertable projector_irrep::make_d2h_table() const {
 }
 
 
+/// functor wrapper that vanishes outside the symmetry-unique wedge of the cell
+
+/// boxes outside the wedge are screened, so the wrapped functor is never
+/// evaluated there and the projection does not refine them
+template<typename T, std::size_t NDIM>
+class wedge_functor : public FunctionFunctorInterface<T,NDIM> {
+	const projector_irrep& proj;
+	std::shared_ptr<FunctionFunctorInterface<T,NDIM> > functor;
+public:
+	wedge_functor(const projector_irrep& proj,
+			std::shared_ptr<FunctionFunctorInterface<T,NDIM> > functor)
+		: proj(proj), functor(functor) {}
+
+	T operator()(const Vector<double,NDIM>& x) const {
+		return functor->operator()(x);
+	}
+
+	bool supports_vectorized() const {return functor->supports_vectorized();}
+
+	void operator()(const Vector<double*,NDIM>& xvals, T* fvals, int npts) const {
+		functor->operator()(xvals,fvals,npts);
+	}
+
+	/// boxes never straddle a symmetry element (except the root box), so
+	/// the box center decides if the box belongs to the wedge
+	bool screened(const Vector<double,NDIM>& c1, const Vector<double,NDIM>& c2) const {
+		if (functor->screened(c1,c2)) return true;
+		return not proj.is_in_wedge(0.5*(c1+c2));
+	}
+
+	/// the special points mapped into the wedge
+	std::vector<Vector<double,NDIM> > special_points() const {
+		std::vector<Vector<double,NDIM> > result;
+		const charactertable table=proj.get_table();
+		for (const Vector<double,NDIM>& p : functor->special_points()) {
+			for (const pg_operator& op : table.operators_) {
+				const Vector<double,NDIM> q=op(p);
+				if (proj.is_in_wedge(q)) {
+					if (std::find(result.begin(),result.end(),q)==result.end()) result.push_back(q);
+					break;
+				}
+			}
+		}
+		return result;
+	}
+
+	Level special_level() {return functor->special_level();}
+};
+
+
+template<typename T, std::size_t NDIM>
+Function<T,NDIM> projector_irrep::project_from_wedge(World& world,
+		std::shared_ptr<FunctionFunctorInterface<T,NDIM> > functor) const {
+
+	MADNESS_CHECK(irrep_!="all");
+
+	const Tensor<double> cell=FunctionDefaults<NDIM>::get_cell();
+	for (std::size_t i=0; i<NDIM; ++i) {
+		if (cell(i,0)!=-cell(i,1)) {
+			MADNESS_EXCEPTION("project_from_wedge requires a cell symmetric about the origin",1);
+		}
+	}
+
+	// the root box straddles all symmetry elements
+	const int initial_level=std::max(1,FunctionDefaults<NDIM>::get_initial_level());
+	std::shared_ptr<FunctionFunctorInterface<T,NDIM> > wf(new wedge_functor<T,NDIM>(*this,functor));
+	Function<T,NDIM> fwedge=FunctionFactory<T,NDIM>(world).functor(wf).initial_level(initial_level);
+
+	// f = \sum_g \chi(g) g(f_wedge), since \chi(g)^2=1 for the abelian groups
+	const charactertable::characterlineT& cline=table_.irreps_.find(irrep_)->second;
+	std::vector<Function<T,NDIM> > result=zero_functions_compressed<T,NDIM>(world,1,false);
+	std::vector<Function<T,NDIM> > opf(table_.operators_.size());
+	for (std::size_t iop=0; iop<table_.operators_.size(); ++iop) {
+		opf[iop]=table_.operators_[iop](fwedge,false);
+	}
+	world.gop.fence();
+	for (std::size_t iop=0; iop<cline.size(); ++iop) {
+		gaxpy(world,1.0,result,double(cline[iop]),std::vector<Function<T,NDIM> >(1,opf[iop]),false);
+	}
+	world.gop.fence();
+	return result[0];
+}
+
+
 // explicit instantiation
+template Function<double,1> projector_irrep::project_from_wedge(World& world,
+		std::shared_ptr<FunctionFunctorInterface<double,1> > functor) const;
+template Function<double,2> projector_irrep::project_from_wedge(World& world,
+		std::shared_ptr<FunctionFunctorInterface<double,2> > functor) const;
+template Function<double,3> projector_irrep::project_from_wedge(World& world,
+		std::shared_ptr<FunctionFunctorInterface<double,3> > functor) const;
+
 template std::vector<Function<double,1> > projector_irrep::project_on_irreps (
 		const std::vector<Function<double,1> >& vhrs, const std::vector<std::string>& irreps) const;
 template std::vector<Function<double,2> > projector_irrep::project_on_irreps (
@@ -68,6 +68,9 @@ namespace madness {
 
 	template<typename T, std::size_t NDIM>
 	class Function;
+
+	template<typename T, std::size_t NDIM>
+	class FunctionFunctorInterface;
 }
 
 
@@ -275,6 +278,31 @@ public:
 
 	}
 
+	/// project a functor transforming as the current irrep, evaluating it only in the symmetry-unique wedge
+
+	/// The functor is projected on the boxes of the wedge only, the rest of
+	/// the function is generated by applying the symmetry operators, which
+	/// reduces the cost of the projection by the order of the point group.
+	/// The simulation cell must be symmetric about the origin.
+	/// @param[in]	functor	a functor belonging to the irrep of this projector
+	/// @return		the function in the full simulation cell
+	template<typename T, std::size_t NDIM>
+	Function<T,NDIM> project_from_wedge(World& world,
+			std::shared_ptr<FunctionFunctorInterface<T,NDIM> > functor) const;
+
+	/// check if the point x lies in the symmetry-unique wedge of the simulation cell
+
+	/// the wedge contains all points that are lexicographically smallest among
+	/// their symmetry-equivalent points
+	template<std::size_t NDIM>
+	bool is_in_wedge(const Vector<double,NDIM>& x) const {
+		for (const pg_operator& op : table_.operators_) {
+			const Vector<double,NDIM> y=op(x);
+			if (y<x) return false;
+		}
+		return true;
+	}
+
 	/// print the character table
 	void print_character_table() const {
 		print("character table for point group ",table_.schoenflies_);
@@ -31,6 +31,7 @@
 
 #include <madness.h>
 #include<madness/chem/SCFOperators.h>
+#include<madness/chem/exchangeoperator.h>
 #include<madness/chem/SCF.h>
 #include<madness/chem/nemo.h>
 #include<madness/chem/correlationfactor.h>
@@ -522,6 +523,41 @@ int test_exchange(World& world) {
     return 0;
 }
 
+/// screening must skip distant orbital pairs without changing the result
+template<typename T>
+int test_exchange_screening(World& world) {
+
+    FunctionDefaults<3>::set_thresh(1.e-5);
+    double thresh=FunctionDefaults<3>::get_thresh();
+    if (world.rank()==0) print("\nentering test_exchange_screening",thresh,typeid(T).name());
+    FunctionDefaults<3>::set_cubic_cell(-10, 10);
+
+    // two orbitals far apart
+    std::vector<Function<T,3> > amo(2);
+    amo[0]=FunctionFactory<T,3>(world).functor(GaussianGuess<T,3>({-6.0,0.0,0.0},2.0)).thresh(thresh*0.1);
+    amo[1]=FunctionFactory<T,3>(world).functor(GaussianGuess<T,3>({6.0,0.0,0.0},2.0)).thresh(thresh*0.1);
+
+    Tensor<double> bounds=Exchange<T,3>::ExchangeImpl::compute_pair_bounds(world,amo,amo);
+    if (world.rank()==0) print("pair bounds\n",bounds);
+    int success=0;
+    if (bounds(0,1)>1.e-6*bounds(0,0)) success++;
+    if (std::abs(bounds(0,1)-bounds(1,0))>1.e-12) success++;
+
+    Exchange<T,3> K(world,1.e-4);
+    K.set_bra_and_ket(conj(world, amo), amo);
+    K.set_algorithm(Exchange<T,3>::multiworld_efficient);
+    std::vector<Function<T,3> > Kamo=K(amo);
+    K.set_screening(1.0);
+    std::vector<Function<T,3> > Kamo_screened=K(amo);
+    auto [ncomputed,nskipped]=Exchange<T,3>::ExchangeImpl::get_pair_statistics(world);
+    if (world.rank()==0) print("pairs computed, skipped",ncomputed,nskipped);
+    if (nskipped==0) success++;
+
+    double err=norm2(world,Kamo-Kamo_screened);
+    if (check_err(err,thresh,"screened exchange error")) success++;
+    return success;
+}
+
 template<typename T>
 int test_XCOperator(World& world) {
 
@@ -979,6 +1015,7 @@ int main(int argc, char** argv) {
 #ifndef HAVE_GENTENSOR
     	result+=test_exchange<double_complex>(world);
 #endif
+    	result+=test_exchange_screening<double>(world);
     	result+=test_XCOperator<double>(world);
 #ifndef HAVE_GENTENSOR
     	result+=test_XCOperator<double_complex>(world);
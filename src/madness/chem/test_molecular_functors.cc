@@ -0,0 +1,172 @@
+/*
+ * test_molecular_functors.cc
+ *
+ * tests that the vectorized evaluation of the molecular functors, used when
+ * projecting them, agrees with their pointwise evaluation
+ */
+
+#include <madness/mra/mra.h>
+#include <madness/chem/correlationfactor.h>
+#include <madness/chem/molecular_functors.h>
+#include <madness/chem/potentialmanager.h>
+#include <madness/world/test_utilities.h>
+
+using namespace madness;
+
+/// a water-like molecule with unequal bond lengths
+Molecule make_molecule() {
+    Molecule molecule;
+    molecule.add_atom(0.0, 0.0, 0.0, 8.0, 8);
+    molecule.add_atom(0.0, 1.4, 1.1, 1.0, 1);
+    molecule.add_atom(0.3, -1.5, 1.0, 1.0, 1);
+    return molecule;
+}
+
+/// test points: on the nuclei, close to the nuclei, in the bonding region and far away
+std::vector<coord_3d> make_points(const Molecule& molecule) {
+    std::vector<coord_3d> points;
+    for (const coord_3d& c : molecule.get_all_coords_vec()) {
+        points.push_back(c);
+        for (double d : {1.e-10, 1.e-6, 1.e-3, 1.e-1}) {
+            points.push_back(c+coord_3d{d,0.0,0.0});
+            points.push_back(c+coord_3d{-0.5*d,0.3*d,-0.8*d});
+        }
+    }
+    for (int i=0; i<100; ++i) {
+        points.push_back(coord_3d{6.0*sin(1.1*i), 6.0*cos(0.7*i), 6.0*sin(0.3*i+1.0)});
+    }
+    for (double r : {10.0, 25.0, 50.0}) points.push_back(coord_3d{r,-0.5*r,0.2*r});
+    return points;
+}
+
+/// largest relative difference between the batch and the pointwise evaluation
+double batch_vs_scalar(const FunctionFunctorInterface<double,3>& f, const std::vector<coord_3d>& points) {
+    MADNESS_CHECK(f.supports_vectorized());
+    const long npt=points.size();
+    std::vector<double> x(npt), y(npt), z(npt), batch(npt);
+    for (long i=0; i<npt; ++i) {
+        x[i]=points[i][0];
+        y[i]=points[i][1];
+        z[i]=points[i][2];
+    }
+    Vector<double*,3> xvals{x.data(),y.data(),z.data()};
+    f(xvals,batch.data(),npt);
+
+    double err=0.0;
+    for (long i=0; i<npt; ++i) {
+        const double scalar=f(points[i]);
+        if (std::isnan(scalar)!=std::isnan(batch[i])) return std::numeric_limits<double>::infinity();
+        err=std::max(err,std::abs(batch[i]-scalar)/std::max(1.0,std::abs(scalar)));
+    }
+    return err;
+}
+
+/// R, U1 and U2 functors and their atomic variants of all nuclear correlation factors
+int test_ncf_functors(World& world) {
+    test_output t("nuclear correlation factor functors, batch vs scalar");
+    const Molecule molecule=make_molecule();
+    const std::vector<coord_3d> points=make_points(molecule);
+    typedef NuclearCorrelationFactor ncfT;
+
+    for (std::string type : {"gaussslater","slater","slater 2.0","linearslater","ggs","poly4erfc","polynomial4"}) {
+        std::shared_ptr<ncfT> ncf=create_nuclear_correlation_factor(world,molecule,nullptr,type);
+        double err=0.0;
+        for (int e : {1,-1,2,3}) err=std::max(err,batch_vs_scalar(ncfT::R_functor(ncf.get(),e),points));
+        err=std::max(err,batch_vs_scalar(ncfT::U2_functor(ncf.get()),points));
+        for (int axis=0; axis<3; ++axis) {
+            err=std::max(err,batch_vs_scalar(ncfT::U1_functor(ncf.get(),axis),points));
+        }
+        for (size_t iatom=0; iatom<molecule.natom(); ++iatom) {
+            err=std::max(err,batch_vs_scalar(ncfT::U2_atomic_functor(ncf.get(),iatom),points));
+            for (int axis=0; axis<3; ++axis) {
+                err=std::max(err,batch_vs_scalar(ncfT::U1_atomic_functor(ncf.get(),iatom,axis),points));
+            }
+        }
+        print(type,"max deviation",err);
+        t.checkpoint(err<1.e-12,type);
+    }
+    return t.end();
+}
+
+/// the molecular and atomic nuclear attraction potentials and their derivatives
+int test_potential_functors(World& world) {
+    test_output t("nuclear potential functors, batch vs scalar");
+    const Molecule molecule=make_molecule();
+    const std::vector<coord_3d> points=make_points(molecule);
+
+    double err=batch_vs_scalar(MolecularPotentialFunctor(molecule),points);
+    print("molecular potential, max deviation",err);
+    t.checkpoint(err<1.e-12,"molecular potential");
+
+    err=0.0;
+    for (size_t iatom=0; iatom<molecule.natom(); ++iatom) {
+        err=std::max(err,batch_vs_scalar(madchem::AtomicAttractionFunctor(molecule,iatom),points));
+    }
+    print("atomic potentials, max deviation",err);
+    t.checkpoint(err<1.e-12,"atomic potentials");
+
+    err=0.0;
+    for (size_t iatom=0; iatom<molecule.natom(); ++iatom) {
+        for (int axis=0; axis<3; ++axis) {
+            err=std::max(err,batch_vs_scalar(madchem::MolecularDerivativeFunctor(molecule,iatom,axis),points));
+            for (int jaxis=0; jaxis<3; ++jaxis) {
+                err=std::max(err,batch_vs_scalar(
+                        madchem::MolecularSecondDerivativeFunctor(molecule,iatom,axis,jaxis),points));
+            }
+        }
+    }
+    print("potential derivatives, max deviation",err);
+    t.checkpoint(err<1.e-12,"potential derivatives");
+    return t.end();
+}
+
+/// atomic basis functions of s to f type, and their screening of far-away boxes
+int test_atomic_basis_functor(World& world) {
+    test_output t("atomic basis functor, batch vs scalar");
+    const Molecule molecule=make_molecule();
+    const std::vector<coord_3d> points=make_points(molecule);
+    const coord_3d center{0.2,-0.1,0.4};
+
+    for (int type=0; type<4; ++type) {
+        const ContractedGaussianShell shell(type,{0.2,0.5,0.4},{40.0,4.0,0.5});
+        double err=0.0;
+        bool screening_ok=true;
+        for (int ibf=0; ibf<shell.nbf(); ++ibf) {
+            const AtomicBasisFunction aofunc(center[0],center[1],center[2],shell,ibf);
+            const madchem::AtomicBasisFunctor functor(aofunc);
+            std::vector<coord_3d> pts=points;
+            for (double d : {0.0, 1.e-8, 1.e-3}) pts.push_back(center+coord_3d{d,-d,0.5*d});
+            err=std::max(err,batch_vs_scalar(functor,pts));
+
+            // a box containing the center is not screened, a box beyond the range is,
+            // and the function vanishes at its corners
+            const double range=sqrt(shell.rangesq());
+            const coord_3d lo=center+coord_3d{range*1.01,-1.0,-1.0};
+            const coord_3d hi=center+coord_3d{range*1.01+2.0,1.0,1.0};
+            screening_ok=screening_ok and (not functor.screened(center-coord_3d(0.1),center+coord_3d(0.1)));
+            screening_ok=screening_ok and functor.screened(lo,hi);
+            screening_ok=screening_ok and (not functor.screened(lo-coord_3d{0.02*range,0.0,0.0},hi));
+            screening_ok=screening_ok and (functor(lo)==0.0) and (functor(hi)==0.0);
+        }
+        print("angular momentum",type,"max deviation",err);
+        t.checkpoint(err<1.e-12 and screening_ok,"angular momentum "+std::to_string(type));
+    }
+    return t.end();
+}
+
+int main(int argc, char** argv) {
+    madness::initialize(argc, argv);
+
+    madness::World world(SafeMPI::COMM_WORLD);
+    world.gop.fence();
+    startup(world,argc,argv);
+
+    int result=0;
+    result+=test_ncf_functors(world);
+    result+=test_potential_functors(world);
+    result+=test_atomic_basis_functor(world);
+
+    print("result",result);
+    madness::finalize();
+    return result;
+}
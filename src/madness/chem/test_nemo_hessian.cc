@@ -0,0 +1,53 @@
+/*
+ * test_nemo_hessian.cc
+ *
+ * regression test for the Hessian of LiH: the CPHF equations solved concurrently
+ * in subworlds must give the same Hessian as the serial solution in the universe
+ */
+
+#include <madness/chem/nemo.h>
+#include <madness/world/test_utilities.h>
+#include <write_test_input.h>
+
+using namespace madness;
+
+/// compute the LiH Hessian at low precision with or without subworlds for the CPHF equations
+Tensor<double> compute_hessian(World& world, commandlineparser parser, const bool subworlds) {
+    Nemo::NemoCalculationParameters param;
+    param.set_user_defined_value<std::vector<double>>("protocol",{1.e-4});
+    param.set_user_defined_value("k",6);
+    param.set_user_defined_value("econv",1.e-4);
+    param.set_user_defined_value("dconv",1.e-3);
+    param.set_user_defined_value("xc",std::string("hf"));
+    param.set_user_defined_value("print_level",1);
+    param.set_user_defined_value("cphf_subworlds",subworlds);
+    write_test_input test_input(param,"lih");
+    parser.set_keyval("input",test_input.filename());
+
+    Nemo nemo(world,parser);
+    nemo.value();
+    return nemo.hessian(nemo.get_calc()->molecule.get_all_coords());
+}
+
+int main(int argc, char** argv) {
+    int result=0;
+    {
+        World& world=madness::initialize(argc, argv);
+        startup(world,argc,argv);
+        commandlineparser parser(argc,argv);
+
+        test_output t("LiH hessian, CPHF in subworlds vs serial");
+        Tensor<double> serial=compute_hessian(world,parser,false);
+        Tensor<double> subworlds=compute_hessian(world,parser,true);
+        const double diff=(serial-subworlds).absmax();
+        print("serial hessian");
+        print(serial);
+        print("hessian from subworlds");
+        print(subworlds);
+        print("max difference",diff);
+        t.checkpoint(diff<1.e-3*serial.absmax(),"hessian");
+        result=t.end();
+    }
+    madness::finalize();
+    return result;
+}
@@ -313,6 +313,53 @@ int test_projector(World& world) {
 	return result;
 }
 
+/// a shifted gaussian symmetrized to transform as a given irrep
+struct symmetrized_gaussian : public FunctionFunctorInterface<double,3> {
+	charactertable table;
+	std::string irrep;
+	symmetrized_gaussian(const charactertable& table, const std::string& irrep)
+		: table(table), irrep(irrep) {}
+
+	double operator()(const coord_3d& r) const {
+		double result=0.0;
+		for (std::size_t i=0; i<table.operators_.size(); ++i) {
+			result+=table.irreps_.find(irrep)->second[i]*gaussian_shift_3d(table.operators_[i](r));
+		}
+		return result;
+	}
+};
+
+/// project symmetric functions from the symmetry-unique wedge, compare to the full projection
+int test_project_from_wedge(World& world) {
+
+	double error=0.0;
+	std::string all_pg[]={"c1","cs","c2","ci","c2v","c2h","d2","d2h"};
+	for (const std::string& pg : all_pg) {
+		print("point group",pg);
+		projector_irrep proj(pg);
+
+		for (const std::string& irrep : proj.get_all_irreps()) {
+			proj.set_irrep(irrep);
+			std::shared_ptr<FunctionFunctorInterface<double,3> > functor(
+					new symmetrized_gaussian(proj.get_table(),irrep));
+			const real_function_3d ref=real_factory_3d(world).functor(functor);
+			const real_function_3d f=proj.project_from_wedge(world,functor);
+			double n1=(f-ref).norm2();
+			print(" irrep, norm, error",irrep,ref.norm2(),n1);
+			error+=n1;
+		}
+	}
+
+	int result=0;
+	if (error > 10.0*FunctionDefaults<3>::get_thresh()) {
+		print("large error norm test_project_from_wedge:", error);
+		result=1;
+	} else {
+		print("  .. all good");
+	}
+	return result;
+}
+
 int test_orthogonalization(World& world) {
 
 	int result=0;
@@ -399,6 +446,7 @@ int main(int argc, char** argv) {
     result+=check_multiplication_table_c2v(world);
     result+=test_projector(world);
     result+=test_orthogonalization(world);
+    result+=test_project_from_wedge(world);
 //    plot_symmetry_operators(world);
 
     print("result",result);
@@ -0,0 +1,246 @@
+/*
+ * test_xc_native.cc
+ *
+ * tests the built-in xc kernels against reference values, the finite-difference
+ * derivatives of the energy density, and, with libxc, against the libxc kernels
+ */
+
+#include <madness/mra/mra.h>
+#include <madness/chem/xcfunctional.h>
+#include <madness/chem/xcfunctional_native.h>
+#include <madness/world/test_utilities.h>
+
+using namespace madness;
+
+/// density and reduced gradient sigma=|grad rho|^2 of the test points
+const std::vector<std::pair<double,double> > points={
+        {1.e-3,2.e-7},{0.05,1.e-3},{0.3,0.08},{1.0,0.5},{12.0,40.0}};
+
+/// energy density, d e/d rho and d e/d sigma of the single components at the test points
+
+/// The values are computed independently of the kernels from the published formulas
+/// (for LYP the spin-resolved form of Miehlich et al.), with the derivatives from a
+/// complex-step differentiation.
+const std::vector<std::pair<std::string,std::vector<std::array<double,3> > > > reference={
+        {"LDA_X", {
+            {-7.38558766382022729e-05, -9.84745021842697021e-02, 0.00000000000000000e+00},
+            {-1.36043687947417884e-02, -3.62783167859780931e-01, 0.00000000000000000e+00},
+            {-1.48324672136449537e-01, -6.59220765050886892e-01, 0.00000000000000000e+00},
+            {-7.38558766382022336e-01, -9.84745021842696300e-01, 0.00000000000000000e+00},
+            {-2.02905297321628737e+01, -2.25450330357365258e+00, 0.00000000000000000e+00}}},
+        {"LDA_C_VWN", {
+            {-2.48647949289819278e-05, -2.97181942740259060e-02, 0.00000000000000000e+00},
+            {-2.41857019489454851e-03, -5.54543937735831674e-02, 0.00000000000000000e+00},
+            {-1.85432270230058913e-02, -6.97024933327572149e-02, 0.00000000000000000e+00},
+            {-7.15926123067906622e-02, -7.99383831759856306e-02, 0.00000000000000000e+00},
+            {-1.11947910499165992e+00, -1.02363309135505426e-01, 0.00000000000000000e+00}}},
+        {"LDA_C_VWN_RPA", {
+            {-3.90908700338812434e-05, -4.51088114271658361e-02, 0.00000000000000000e+00},
+            {-3.32433346068791930e-03, -7.43880674823122201e-02, 0.00000000000000000e+00},
+            {-2.43778573126771266e-02, -8.98249491466195371e-02, 0.00000000000000000e+00},
+            {-9.18004225662869405e-02, -1.00735030038527254e-01, 0.00000000000000000e+00},
+            {-1.37724587481385585e+00, -1.24284849051374949e-01, 0.00000000000000000e+00}}},
+        {"GGA_X_B88", {
+            {-8.17244428966959268e-05, -9.17647894739223868e-02, -3.22521269781353581e+01},
+            {-1.38697419854839805e-02, -3.56569514069279725e-01, -2.49192603942995389e-01},
+            {-1.50313599749556742e-01, -6.51205005813736859e-01, -2.37029590091623193e-02},
+            {-7.41157798859033767e-01, -9.81391780902793109e-01, -5.11396318193886850e-03},
+            {-2.02982181501206220e+01, -2.25365255344663851e+00, -1.91814613760931296e-04}}},
+        {"GGA_X_PBE", {
+            {-8.12683606815120773e-05, -9.10586788072469677e-02, -3.24358789401921328e+01},
+            {-1.38295409452949200e-02, -3.57025802889041288e-01, -2.20536668477934933e-01},
+            {-1.49988096430990203e-01, -6.52034013510750632e-01, -2.05027711941957111e-02},
+            {-7.40668686355070327e-01, -9.81951787366159401e-01, -4.20484583045065748e-03},
+            {-2.02966932609649646e+01, -2.25381898452407103e+00, -1.54030003104124638e-04}}},
+        {"GGA_C_PBE", {
+            {-1.77036853017105949e-05, -3.64515503087713411e-02, 2.99987659165712159e+01},
+            {-2.20085025145311816e-03, -6.03022356503142981e-02, 1.99427485496569884e-01},
+            {-1.69126154119163055e-02, -7.52396910224145538e-02, 1.78161481841551672e-02},
+            {-6.91517203897714372e-02, -8.20333787532940562e-02, 3.96418082307966289e-03},
+            {-1.10706255868265568e+00, -1.02491632779968672e-01, 1.51640017764684694e-04}}},
+        {"GGA_C_LYP", {
+            {-1.04481280806776054e-05, -1.51562411577643944e-02, 4.17399836414685232e+00},
+            {-1.46490206153059629e-03, -3.71781967548031819e-02, 3.84853034977647585e-02},
+            {-1.20213223686953807e-02, -4.74664414418515535e-02, 2.42995797577581253e-03},
+            {-4.70112097738287424e-02, -5.24388540095180461e-02, 3.41590456470242099e-04},
+            {-6.85644531108631883e-01, -6.02381720940666082e-02, 5.23433460320288500e-06}}}
+};
+
+/// evaluate the restricted kernel of f at the points
+
+/// @return energy density, d e/d rho and d e/d sigma for each point
+std::vector<std::array<double,3> > evaluate(const xc_native::functional& f,
+        const std::vector<std::pair<double,double> >& pts) {
+    const long np=pts.size();
+    std::vector<double> rhoa(np), chi(np), zx(np), zy(np,0.0), zz(np,0.0);
+    std::vector<double> e(np), vr(np), vx(np), vy(np), vz(np);
+    for (long i=0; i<np; ++i) {
+        const auto [rho,sigma]=pts[i];
+        rhoa[i]=0.5*rho;
+        chi[i]=sigma/(rho*rho);                 // |grad zeta|^2 = sigma/rho^2
+        zx[i]=std::sqrt(chi[i]);
+    }
+    const double* zeta[3]={zx.data(),zy.data(),zz.data()};
+    double* vsig[3]={vx.data(),vy.data(),vz.data()};
+    bool ok=xc_native::restricted_kernel(f,np,0.0,0.0,rhoa.data(),chi.data(),zeta,
+            e.data(),vr.data(),vsig);
+    MADNESS_CHECK(ok);
+
+    std::vector<std::array<double,3> > result(np);
+    for (long i=0; i<np; ++i) {
+        const double rho=pts[i].first;
+        const double vs=f.is_gga() ? vx[i]/(2.0*rho*zx[i]) : 0.0;   // vsig = 2 vs grad rho
+        result[i]={e[i],vr[i],vs};
+    }
+    return result;
+}
+
+/// largest relative deviation of the values from the reference values
+double max_deviation(const std::vector<std::array<double,3> >& val,
+        const std::vector<std::array<double,3> >& ref) {
+    double err=0.0;
+    for (std::size_t i=0; i<val.size(); ++i) {
+        for (int j=0; j<3; ++j) {
+            err=std::max(err,std::abs(val[i][j]-ref[i][j])/std::max(std::abs(ref[i][j]),1.e-12));
+        }
+    }
+    return err;
+}
+
+/// compare the single components to the reference values
+int test_components(World& world) {
+    test_output t("xc_native components vs reference");
+    for (const auto& [name,ref] : reference) {
+        xc_native::functional f;
+        MADNESS_CHECK(f.add_component(name,1.0));
+        const double err=max_deviation(evaluate(f,points),ref);
+        print(name,"max relative deviation",err);
+        t.checkpoint(err<1.e-10,name);
+    }
+    return t.end();
+}
+
+/// compare the named combinations to the weighted sums of the reference values
+int test_combinations(World& world) {
+    test_output t("xc_native combinations vs reference");
+    const std::vector<std::tuple<std::string,double,std::vector<std::pair<std::string,double> > > > combinations={
+            {"LDA",0.0,{{"LDA_X",1.0},{"LDA_C_VWN",1.0}}},
+            {"BLYP",0.0,{{"GGA_X_B88",1.0},{"GGA_C_LYP",1.0}}},
+            {"PBE",0.0,{{"GGA_X_PBE",1.0},{"GGA_C_PBE",1.0}}},
+            {"PBE0",0.25,{{"GGA_X_PBE",0.75},{"GGA_C_PBE",1.0}}},
+            {"B3LYP",0.2,{{"LDA_X",0.08},{"GGA_X_B88",0.72},{"LDA_C_VWN_RPA",0.19},{"GGA_C_LYP",0.81}}}};
+
+    for (const auto& [name,hf_ref,components] : combinations) {
+        xc_native::functional f;
+        double hf=0.0;
+        MADNESS_CHECK(f.add_combination(name,hf));
+
+        std::vector<std::array<double,3> > ref(points.size(),{0.0,0.0,0.0});
+        for (const auto& [cname,weight] : components) {
+            auto it=std::find_if(reference.begin(),reference.end(),
+                    [&cname](const auto& r) {return r.first==cname;});
+            MADNESS_CHECK(it!=reference.end());
+            for (std::size_t i=0; i<points.size(); ++i) {
+                for (int j=0; j<3; ++j) ref[i][j]+=weight*it->second[i][j];
+            }
+        }
+        const double err=max_deviation(evaluate(f,points),ref);
+        print(name,"max relative deviation",err,"hf coefficient",hf);
+        t.checkpoint(err<1.e-10 and hf==hf_ref,name);
+    }
+    xc_native::functional f;
+    double hf=0.0;
+    t.checkpoint(not f.add_combination("BP86",hf),"unknown combination");
+    return t.end();
+}
+
+/// compare the potentials to the finite-difference derivatives of the energy density
+int test_derivatives(World& world) {
+    test_output t("xc_native potentials vs finite differences");
+    const double h=1.e-5;
+    for (const auto& [name,ref] : reference) {
+        xc_native::functional f;
+        f.add_component(name,1.0);
+        double maxerr=0.0;
+        for (long i=0; i<40; ++i) {
+            const double rho=std::pow(10.0,-4.0+6.0*i/39.0);
+            const double sigma=rho*rho*(0.1+0.05*i);
+            const std::vector<std::pair<double,double> > pts={{rho,sigma},
+                    {rho*(1.0+h),sigma},{rho*(1.0-h),sigma},
+                    {rho,sigma*(1.0+h)},{rho,sigma*(1.0-h)}};
+            const auto val=evaluate(f,pts);
+
+            // d/d rho at fixed sigma, d/d sigma at fixed rho
+            const double vr_fd=(val[1][0]-val[2][0])/(2.0*h*rho);
+            maxerr=std::max(maxerr,std::abs(vr_fd-val[0][1])/std::max(std::abs(val[0][1]),1.e-10));
+            if (f.is_gga()) {
+                const double vs_fd=(val[3][0]-val[4][0])/(2.0*h*sigma);
+                maxerr=std::max(maxerr,std::abs(vs_fd-val[0][2])/std::max(std::abs(val[0][2]),1.e-10));
+            }
+        }
+        print(name,"max relative finite-difference error",maxerr);
+        t.checkpoint(maxerr<1.e-6,name);
+    }
+    return t.end();
+}
+
+#ifdef MADNESS_HAS_LIBXC
+/// compare the native kernels to the libxc kernels through the XCfunctional interface
+int test_libxc(World& world) {
+    test_output t("xc_native vs libxc");
+    const long np=points.size();
+    std::vector<Tensor<double> > xc_args(XCfunctional::number_xc_args);
+    Tensor<double> rhoa(np), chi(np), zx(np), zy(np), zz(np);
+    for (long i=0; i<np; ++i) {
+        const auto [rho,sigma]=points[i];
+        rhoa(i)=0.5*rho;
+        chi(i)=sigma/(rho*rho);
+        zx(i)=std::sqrt(chi(i));
+    }
+    xc_args[XCfunctional::enum_rhoa]=rhoa;
+    xc_args[XCfunctional::enum_chi_aa]=chi;
+    xc_args[XCfunctional::enum_zetaa_x]=zx;
+    xc_args[XCfunctional::enum_zetaa_y]=zy;
+    xc_args[XCfunctional::enum_zetaa_z]=zz;
+
+    std::vector<std::string> lines={"LDA","PBE","PBE0","B3LYP"};
+    for (const auto& r : reference) lines.push_back(r.first+" 1.0");
+    for (const std::string& line : lines) {
+        XCfunctional native, libxc;
+        native.initialize("native "+line,false,world);
+        libxc.initialize(line,false,world);
+
+        auto reldiff=[](const Tensor<double>& a, const Tensor<double>& b) {
+            return (a-b).normf()/std::max(b.normf(),1.e-12);
+        };
+        double err=reldiff(native.exc(xc_args),libxc.exc(xc_args));
+        std::vector<Tensor<double> > vn=native.vxc(xc_args,0), vl=libxc.vxc(xc_args,0);
+        MADNESS_CHECK(vn.size()==vl.size());
+        for (std::size_t i=0; i<vn.size(); ++i) err=std::max(err,reldiff(vn[i],vl[i]));
+        print(line,"relative deviation from libxc",err);
+        t.checkpoint(err<1.e-8,line);
+    }
+    return t.end();
+}
+#endif
+
+int main(int argc, char** argv) {
+    madness::initialize(argc, argv);
+
+    madness::World world(SafeMPI::COMM_WORLD);
+    world.gop.fence();
+    startup(world,argc,argv);
+
+    int result=0;
+    result+=test_components(world);
+    result+=test_combinations(world);
+    result+=test_derivatives(world);
+#ifdef MADNESS_HAS_LIBXC
+    result+=test_libxc(world);
+#endif
+
+    print("result",result);
+
+    madness::finalize();
+    return result;
+}
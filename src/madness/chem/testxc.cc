@@ -33,7 +33,9 @@
 #include <madness/mra/mra.h>
 #include <madness/tensor/tensor.h>
 #include <fstream>
-#include "xcfunctional.h"
+#include <madness/chem/xcfunctional.h>
+#include <madness/chem/xcfunctional_native.h>
+#include <madness/world/timers.h>
 
 using namespace madness;
 
@@ -306,13 +308,114 @@ void test_xcfunctional(World& world)
 
 }
 
+/// check the built-in kernels for consistency of energy and potential by finite differences
+
+/// @return the largest relative error in d e/d rho and d e/d sigma
+double check_native_kernel(const std::string& name) {
+    xc_native::functional f;
+    double hf=0.0;
+    f.add_combination(name,hf);
+
+    const long np=40;
+    const double h=1.e-5;
+    double maxerr=0.0;
+    for (long i=0; i<np; ++i) {
+        const double rho=std::pow(10.0,-4.0+6.0*i/(np-1));     // total density
+        const double chi=0.1+0.05*i;                            // |grad zeta|^2
+        auto eval=[&](const double r, const double c, double& e, double& vr, double& vs) {
+            const double rhoa=0.5*r;
+            const double zx=std::sqrt(c), zy=0.0, zz=0.0;
+            const double* zeta[3]={&zx,&zy,&zz};
+            double vx, vy, vz;
+            double* vsig[3]={&vx,&vy,&vz};
+            xc_native::restricted_kernel(f,1,0.0,0.0,&rhoa,&c,zeta,&e,&vr,vsig);
+            vs=vx/(2.0*r*std::sqrt(c));                         // vsig = 2 vs grad rho
+        };
+        double e, vr, vs, ep, em, dum;
+        eval(rho,chi,e,vr,vs);
+        const double sigma=rho*rho*chi;
+
+        // d/d rho at fixed sigma
+        const double rp=rho*(1.0+h), rm=rho*(1.0-h);
+        eval(rp,sigma/(rp*rp),ep,dum,dum);
+        eval(rm,sigma/(rm*rm),em,dum,dum);
+        const double vr_fd=(ep-em)/(rp-rm);
+        maxerr=std::max(maxerr,std::abs(vr_fd-vr)/std::max(std::abs(vr),1.e-10));
+
+        // d/d sigma at fixed rho
+        if (f.is_gga()) {
+            eval(rho,chi*(1.0+h),ep,dum,dum);
+            eval(rho,chi*(1.0-h),em,dum,dum);
+            const double vs_fd=(ep-em)/(2.0*h*sigma);
+            maxerr=std::max(maxerr,std::abs(vs_fd-vs)/std::max(std::abs(vs),1.e-10));
+        }
+    }
+    return maxerr;
+}
+
+/// throughput of the xc energy and potential evaluation on a box-sized set of points
+
+/// each functional is run through the XCfunctional interface, i.e. the path
+/// used by the XC operator; with libxc the built-in kernels are compared
+/// to the libxc ones
+void benchmark_xc_kernels(World& world, const long k=10, const long nbox=400) {
+    const long np=k*k*k;
+    std::vector<Tensor<double> > xc_args(XCfunctional::number_xc_args);
+    Tensor<double> rhoa(k,k,k), chi(k,k,k), zx(k,k,k), zy(k,k,k), zz(k,k,k);
+    for (long i=0; i<np; ++i) {
+        rhoa.ptr()[i]=std::pow(10.0,-8.0+9.0*double(i)/np);
+        zx.ptr()[i]=std::sin(0.1*i);
+        zy.ptr()[i]=std::cos(0.3*i);
+        zz.ptr()[i]=0.5;
+        chi.ptr()[i]=zx.ptr()[i]*zx.ptr()[i]+zy.ptr()[i]*zy.ptr()[i]+zz.ptr()[i]*zz.ptr()[i];
+    }
+    xc_args[XCfunctional::enum_rhoa]=rhoa;
+    xc_args[XCfunctional::enum_chi_aa]=chi;
+    xc_args[XCfunctional::enum_zetaa_x]=zx;
+    xc_args[XCfunctional::enum_zetaa_y]=zy;
+    xc_args[XCfunctional::enum_zetaa_z]=zz;
+
+    std::vector<std::string> variants={"native"};
+#ifdef MADNESS_HAS_LIBXC
+    variants.push_back("libxc");
+#endif
+
+    if (world.rank()==0) {
+        print("\nxc kernel throughput for",nbox,"boxes of",np,"points\n");
+        printf("%8s %8s %12s %12s %12s\n","xc","kernel","exc Mpt/s","vxc Mpt/s","fd error");
+    }
+    for (std::string name : {"LDA","PBE","B3LYP"}) {
+        for (std::string variant : variants) {
+            XCfunctional xc;
+            std::string line=(variant=="native") ? "native "+name : name;
+            xc.initialize(line,false,world);
+
+            double t0=wall_time();
+            double sum=0.0;
+            for (long ibox=0; ibox<nbox; ++ibox) sum+=xc.exc(xc_args)[0];
+            double t1=wall_time();
+            for (long ibox=0; ibox<nbox; ++ibox) sum+=xc.vxc(xc_args,0)[0][0];
+            double t2=wall_time();
+
+            const double mpt=double(np*nbox)*1.e-6;
+            const double fderr=(variant=="native") ? check_native_kernel(name) : 0.0;
+            if (world.rank()==0) printf("%8s %8s %12.2f %12.2f %12.2e\n",name.c_str(),variant.c_str(),
+                    mpt/(t1-t0),mpt/(t2-t1),fderr);
+            if (std::isnan(sum)) print("NaN in",name,variant);
+        }
+    }
+}
+
 int main(int argc, char** argv) {
     madness::initialize(argc, argv);
 
     madness::World world(SafeMPI::COMM_WORLD);
     world.gop.fence();
 
+#ifdef MADNESS_HAS_LIBXC
     test_xcfunctional(world);
+#endif
+    benchmark_xc_kernels(world);
 
     madness::finalize();
     return 0;
@@ -14,6 +14,7 @@
 #include <madness/mra/key.h>
 #include <madness/world/MADworld.h>
 #include <madness/mra/function_common_data.h>
+#include <madness/chem/xcfunctional_native.h>
 
 #ifdef MADNESS_HAS_LIBXC
 #include <xc.h>
@@ -104,6 +105,12 @@ protected:
     std::vector< std::pair<xc_func_type*,double> > funcs;
 #endif
 
+    /// the functional in terms of the built-in kernels, see xcfunctional_native.h
+    xc_native::functional native;
+
+    /// use the built-in kernels instead of libxc (always true without libxc)
+    bool use_native=false;
+
     /// convert the raw density (gradient) data to be used by the xc operators
 
     /// Involves mainly munging of the densities and multiplying with 2
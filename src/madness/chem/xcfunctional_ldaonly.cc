@@ -11,53 +11,88 @@
 namespace madness {
 
 
-int x_rks_s__(const double *r__, double *f, double * dfdra);
-int c_rks_vwn5__(const double *r__, double *f, double * dfdra);
 int x_uks_s__(double *ra, double *rb, double *f, double *dfdra, double *dfdrb);
 int c_uks_vwn5__(double *ra, double *rb, double *f, double *dfdra, double *dfdrb);
 
 XCfunctional::XCfunctional() : hf_coeff(0.0) {
     rhotol=1e-7; rhomin=1e-12; // default values
+    ggatol=1.e-4;
+    nderiv=0;
+    spin_polarized=false;
+    use_native=true;
 }
 
 void XCfunctional::initialize(const std::string& input_line, bool polarized,
         World& world, bool verbose) {
     rhotol=1e-7; rhomin=1e-12; // default values
+    ggatol=1.e-4;
 
     spin_polarized = polarized;
+    use_native=true;
+    native=xc_native::functional();
+    hf_coeff=0.0;
 
     std::stringstream s(input_line);
     std::string token;
     bool found_valid_token = false;
+    double factor;
     while (s >> token) {
         std::transform(token.begin(), token.end(), token.begin(), ::toupper);
-        if (token == "LDA") {
-            hf_coeff = 0.0;
-            found_valid_token = true;
-        }
-        else if (token == "RHOMIN") {
+        if (token == "RHOMIN") {
             s >> rhomin;
         }
         else if (token == "RHOTOL") {
             s >> rhotol;
         }
-        else if (token == "HF") {
-            hf_coeff = 1.0;
+        else if (token == "GGATOL") {
+            s >> ggatol;
+        }
+        else if (token == "HF" || token == "HF_X") {
+            if (! (s >> factor)) factor = 1.0;
+            hf_coeff = factor;
+            found_valid_token = true;
+        }
+        else if (token == "NATIVE") {
+            // built-in kernels are the only option without libxc
+        }
+        else if (native.add_combination(token, hf_coeff)) {
+            found_valid_token = true;
+        }
+        else {
+            if (! (s >> factor)) factor = 1.0;
+            if (not native.add_component(token, factor)) {
+                std::string msg="XCfunctional(ldaonly)::initialize() -- functional "+token+" requires libxc";
+                MADNESS_EXCEPTION(msg.c_str(),1);
+            }
             found_valid_token = true;
         }
     }
     if (not found_valid_token)
         throw "XCfunctional(ldaonly)::initialize() -- did not find a valid XC functional";
+    if (spin_polarized and is_dft() and (not native.is_svwn5()))
+        MADNESS_EXCEPTION("XCfunctional(ldaonly)::initialize() -- spin-polarized calculations only with LDA",1);
+    nderiv = native.is_gga() ? 1 : 0;
+
+    if (verbose and (world.rank()==0)) {
+        print("\nConstruct XC Functional from built-in kernels");
+        print("\ninput line was:",input_line);
+        native.print();
+        if (hf_coeff>0.0) printf(" %4.3f %s \n",hf_coeff,"HF exchange");
+        print("\nscreening parameters");
+        print(" rhotol, rhomin",rhotol,rhomin);
+        print("         ggatol",ggatol);
+        print("polarized ",polarized,"\n");
+    }
 }
 
 XCfunctional::~XCfunctional() {}
 
 bool XCfunctional::is_lda() const {
-    return (hf_coeff == 0.0);
+    return is_dft() and (nderiv == 0);
 }
 
 bool XCfunctional::is_gga() const {
-    return false;
+    return nderiv == 1;
 }
 
 bool XCfunctional::is_meta() const {
@@ -65,7 +100,7 @@ bool XCfunctional::is_meta() const {
 }
 
 bool XCfunctional::is_dft() const {
-    return (is_lda() || is_gga() || is_meta());
+    return not native.empty();
 }
 
 bool XCfunctional::has_fxc() const
@@ -80,37 +115,24 @@ bool XCfunctional::has_kxc() const
 
 madness::Tensor<double> XCfunctional::exc(const std::vector< madness::Tensor<double> >& t) const
 {
+    if (not spin_polarized) return xc_native::exc(native, t, rhotol, rhomin);
+
     const double* arho = t[0].ptr();
     madness::Tensor<double> result(3L, t[0].dims(), false);
     double* f = result.ptr();
-    if (spin_polarized) {
-        const double* brho = t[1].ptr();
-        for (unsigned int i=0; i<result.size(); i++) {
-            double ra = munge(arho[i]);
-            double rb = munge(brho[i]);
-            double xf, cf, xdfdr[2], cdfdr[2];
-
-            x_uks_s__(&ra, &rb, &xf, xdfdr, xdfdr+1);
-            c_uks_vwn5__(&ra, &rb, &cf, cdfdr, cdfdr+1);
-
-            f[i] = xf + cf;
-            if (std::isnan(f[i])) {
-                print("bad 1?", ra, rb);
-                throw "numerical error in lda functional";
-            }
-        }
-    }
-    else {
-        double q1, q2, dq;
-        for (unsigned int i=0; i<result.size(); i++) {
-            double r = munge(2.0 * arho[i]);
-            x_rks_s__(&r, &q1, &dq);
-            c_rks_vwn5__(&r, &q2, &dq);
-            f[i] = q1 + q2;
-            if (std::isnan(f[i])) {
-                print("bad? 2", r);
-                throw "numerical error in lda functional";
-            }
+    const double* brho = t[1].ptr();
+    for (unsigned int i=0; i<result.size(); i++) {
+        double ra = munge(arho[i]);
+        double rb = munge(brho[i]);
+        double xf, cf, xdfdr[2], cdfdr[2];
+
+        x_uks_s__(&ra, &rb, &xf, xdfdr, xdfdr+1);
+        c_uks_vwn5__(&ra, &rb, &cf, cdfdr, cdfdr+1);
+
+        f[i] = xf + cf;
+        if (std::isnan(f[i])) {
+            print("bad 1?", ra, rb);
+            throw "numerical error in lda functional";
         }
     }
     return result;
@@ -120,41 +142,27 @@ std::vector<madness::Tensor<double> > XCfunctional::vxc(const std::vector< madne
         const int ispin) const
 {
     //MADNESS_ASSERT(what == 0);
+    if (not spin_polarized) return xc_native::vxc(native, t, rhotol, rhomin);
+
     const double* arho = t[0].ptr();
     std::vector<madness::Tensor<double> > result(1);
     result[0]=madness::Tensor<double>(3L, t[0].dims(), false);
     double* f = result[0].ptr();
 
-    if (spin_polarized) {
-        const double* brho = t[1].ptr();
-        for (unsigned int i=0; i<result[0].size(); i++) {
-            double ra = munge(arho[i]);
-            double rb = munge(brho[i]);
-            double xf, cf, xdfdr[2], cdfdr[2];
+    const double* brho = t[1].ptr();
+    for (unsigned int i=0; i<result[0].size(); i++) {
+        double ra = munge(arho[i]);
+        double rb = munge(brho[i]);
+        double xf, cf, xdfdr[2], cdfdr[2];
 
-            x_uks_s__(&ra, &rb, &xf, xdfdr, xdfdr+1);
-            c_uks_vwn5__(&ra, &rb, &cf, cdfdr, cdfdr+1);
+        x_uks_s__(&ra, &rb, &xf, xdfdr, xdfdr+1);
+        c_uks_vwn5__(&ra, &rb, &cf, cdfdr, cdfdr+1);
 
 //            f[i] = xdfdr[what] + cdfdr[what];
-            f[i] = xdfdr[ispin] + cdfdr[ispin];
-            if (std::isnan(f[i])) {
-                print("bad? 3", ra, rb);
-                throw "numerical error in lda functional";
-            }
-        }
-    }
-    else {
-        const double* arho = t[0].ptr();
-        for (unsigned int i=0; i<result[0].size(); i++) {
-            double r = munge(2.0 * arho[i]);
-            double q, dq1, dq2;
-            x_rks_s__(&r, &q, &dq1);
-            c_rks_vwn5__(&r, &q, &dq2);
-            f[i] = dq1 + dq2;
-            if (std::isnan(f[i])) {
-                print("bad? 4", r);
-                throw "numerical error in lda functional";
-            }
+        f[i] = xdfdr[ispin] + cdfdr[ispin];
+        if (std::isnan(f[i])) {
+            print("bad? 3", ra, rb);
+            throw "numerical error in lda functional";
         }
     }
     return result;
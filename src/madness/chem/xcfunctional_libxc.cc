@@ -77,10 +77,24 @@ void XCfunctional::initialize(const std::string& input_line, bool polarized,
     nderiv = 0;
     hf_coeff = 0.0;
     funcs.clear();
+    use_native=false;
+    native=xc_native::functional();
+    bool native_available=true;     // all requested functionals have a built-in kernel
+    double native_hf_coeff=0.0;
 
     if (printit) print("\nConstruct XC Functional from LIBXC Library");
     while (line >> name) {
         std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        if (name == "NATIVE") {
+            // use the built-in kernels, bypassing libxc
+            use_native=true;
+            continue;
+        }
+        if ((name == "LDA") or (name == "PBE") or (name == "PBE0") or (name == "B3LYP")) {
+            native.add_combination(name,native_hf_coeff);
+        } else if ((name == "BP86") or (name=="BP")) {
+            native_available=false;
+        }
         if (name == "LDA") {
             // Slater exchange and VWN-5 correlation
             funcs.push_back(std::make_pair(lookup_func("LDA_X",polarized),1.0));
@@ -112,9 +126,15 @@ void XCfunctional::initialize(const std::string& input_line, bool polarized,
         } else {
             if (! (line >> factor)) factor = 1.0;
             funcs.push_back(std::make_pair(lookup_func(name,polarized), factor));
+            native_available = native.add_component(name,factor) and native_available;
         }
     }
 
+    if (use_native) {
+        if (not native_available) MADNESS_EXCEPTION("NATIVE: functional has no built-in kernel, use libxc",1);
+        if (spin_polarized) MADNESS_EXCEPTION("NATIVE: built-in kernels are spin-restricted only",1);
+    }
+
     for (unsigned int i=0; i<funcs.size(); i++) {
         if (funcs[i].first->info->family == XC_FAMILY_GGA) nderiv = std::max(nderiv,1);
         if (funcs[i].first->info->family == XC_FAMILY_HYB_GGA) nderiv = std::max(nderiv,1);
@@ -129,6 +149,10 @@ void XCfunctional::initialize(const std::string& input_line, bool polarized,
             printf(" %4.3f %s \n",funcs[i].second,lookup_id(id).c_str());
         }
         if (hf_coeff>0.0) printf(" %4.3f %s \n",hf_coeff,"HF exchange");
+        if (use_native) {
+            print("\nevaluated with the built-in kernels");
+            native.print();
+        }
         print("\nscreening parameters");
         print(" rhotol, rhomin",rhotol,rhomin);
         print("         ggatol",ggatol);
@@ -367,6 +391,8 @@ void XCfunctional::make_libxc_args(const std::vector< madness::Tensor<double> >&
 
 
 madness::Tensor<double> XCfunctional::exc(const std::vector< madness::Tensor<double> >& t) const {
+    if (use_native) return xc_native::exc(native, t, rhotol, rhomin);
+
     madness::Tensor<double> rho, sigma, rho_pt, sigma_pt;
     std::vector<Tensor<double> > ddens(3), ddens_pt(3);
     make_libxc_args(t, rho, sigma, rho_pt, sigma_pt, ddens, ddens_pt, false);
@@ -413,6 +439,8 @@ madness::Tensor<double> XCfunctional::exc(const std::vector< madness::Tensor<dou
 
 std::vector<madness::Tensor<double> > XCfunctional::vxc(
         const std::vector< madness::Tensor<double> >& t, const int ispin) const {
+    if (use_native) return xc_native::vxc(native, t, rhotol, rhomin);
+
     madness::Tensor<double> rho, sigma, dummy;
     std::vector<Tensor<double> > drho(3), ddens_pt(3);
     make_libxc_args(t, rho, sigma, dummy, dummy, drho, ddens_pt, false);
@@ -0,0 +1,334 @@
+#include <madness/madness_config.h>
+#include <madness/chem/xcfunctional_native.h>
+#include <madness/chem/xcfunctional.h>
+#include <madness/world/madness_exception.h>
+#include <madness/world/print.h>
+#include <algorithm>
+#include <cmath>
+
+namespace madness {
+namespace xc_native {
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+/// number of points processed in one pass, small enough to stay in L1
+const long chunksize = 64;
+
+/// densities below this are not evaluated, cf. libxc's dens_threshold
+const double dens_threshold = 1.e-14;
+
+/// work arrays for a chunk of points
+struct chunk {
+    long n;
+    alignas(64) double rho[chunksize];      ///< munged total density
+    alignas(64) double r13[chunksize];      ///< rho^(1/3)
+    alignas(64) double sigma[chunksize];    ///< |grad rho|^2
+    alignas(64) double mask[chunksize];     ///< 0 for points below the density threshold
+    alignas(64) double e[chunksize];        ///< accumulated energy density
+    alignas(64) double vr[chunksize];       ///< accumulated d e/d rho
+    alignas(64) double vs[chunksize];       ///< accumulated d e/d sigma
+};
+
+const double cbrt3pi2 = std::cbrt(3.0*pi*pi);                  // (3 pi^2)^(1/3)
+const double rs_factor = std::cbrt(3.0/(4.0*pi));               // rs = rs_factor * rho^(-1/3)
+const double cx = 0.75*std::cbrt(3.0/pi);                       // Slater, unpolarized
+const double cx_spin = 1.5*std::cbrt(3.0/(4.0*pi));             // Slater, per spin channel
+
+/// Slater exchange
+void slater(chunk& c, const double w) {
+    const double fac = -w*cx;
+    for (long i=0; i<c.n; ++i) {
+        c.e[i] += fac*c.rho[i]*c.r13[i];
+        c.vr[i] += fac*(4.0/3.0)*c.r13[i];
+    }
+}
+
+/// VWN correlation for the paramagnetic case with parameters A, b, c, x0
+void vwn(chunk& c, const double w, const double A, const double b, const double cc, const double x0) {
+    const double Q = std::sqrt(4.0*cc - b*b);
+    const double X0 = x0*x0 + b*x0 + cc;
+    const double bx0 = b*x0/X0;
+    for (long i=0; i<c.n; ++i) {
+        const double rs = rs_factor/c.r13[i];
+        const double x = std::sqrt(rs);
+        const double X = x*x + b*x + cc;
+        const double tx = 2.0*x + b;
+        const double at = std::atan(Q/tx);
+        const double eps = A*(std::log(x*x/X) + 2.0*b/Q*at
+                - bx0*(std::log((x-x0)*(x-x0)/X) + 2.0*(b+2.0*x0)/Q*at));
+        const double denom = 1.0/(tx*tx + Q*Q);
+        const double deps = A*(2.0/x - tx/X - 4.0*b*denom
+                - bx0*(2.0/(x-x0) - tx/X - 4.0*(b+2.0*x0)*denom));
+        c.e[i] += w*c.rho[i]*eps;
+        c.vr[i] += w*(eps - x*deps/6.0);
+    }
+}
+
+/// Becke 88 exchange, evaluated per spin channel with rho_s=rho/2, sigma_s=sigma/4
+void b88(chunk& c, const double w) {
+    const double beta = 0.0042;
+    const double cbrt2 = std::cbrt(2.0);
+    for (long i=0; i<c.n; ++i) {
+        const double rs13 = c.r13[i]/cbrt2;
+        const double rs43 = 0.5*c.rho[i]*rs13;
+        const double x = 0.5*std::sqrt(c.sigma[i])/rs43;
+        const double ash = std::asinh(x);
+        const double D = 1.0 + 6.0*beta*x*ash;
+        const double dD = 6.0*beta*(ash + x/std::sqrt(1.0 + x*x));
+        const double g = x*x/D;
+        const double gpx = (2.0*D - x*dD)/(D*D);                // g'(x)/x
+        c.e[i] += -2.0*w*rs43*(cx_spin + beta*g);
+        c.vr[i] += -w*(4.0/3.0)*rs13*(cx_spin + beta*g - beta*x*x*gpx);
+        c.vs[i] += -0.25*w*beta*gpx/rs43;
+    }
+}
+
+/// PBE exchange
+void pbe_x(chunk& c, const double w) {
+    const double kappa = 0.804;
+    const double mu = 0.2195149727645171;
+    const double cs = 1.0/(4.0*cbrt3pi2*cbrt3pi2);              // s^2 = cs sigma rho^(-8/3)
+    for (long i=0; i<c.n; ++i) {
+        const double rho43 = c.rho[i]*c.r13[i];
+        const double p = cs*c.sigma[i]/(rho43*rho43);
+        const double kmp = 1.0/(kappa + mu*p);
+        const double F = 1.0 + kappa - kappa*kappa*kmp;
+        const double Fp = kappa*kappa*mu*kmp*kmp;
+        c.e[i] += -w*cx*rho43*F;
+        c.vr[i] += -w*(4.0/3.0)*cx*c.r13[i]*(F - 2.0*p*Fp);
+        c.vs[i] += -w*cx*cs*Fp/rho43;
+    }
+}
+
+/// PBE correlation with the PW92 local part, paramagnetic case
+void pbe_c(chunk& c, const double w) {
+    const double A = 0.0310907, alpha1 = 0.21370;
+    const double beta1 = 7.5957, beta2 = 3.5876, beta3 = 1.6382, beta4 = 0.49294;
+    const double gamma = (1.0 - std::log(2.0))/(pi*pi);
+    const double beta = 0.06672455060314922;
+    const double bg = beta/gamma;
+    const double ct = pi/(16.0*cbrt3pi2);                       // t^2 = ct sigma rho^(-7/3)
+    for (long i=0; i<c.n; ++i) {
+        const double rs = rs_factor/c.r13[i];
+        const double srs = std::sqrt(rs);
+        const double Q1 = 2.0*A*(beta1*srs + beta2*rs + beta3*rs*srs + beta4*rs*rs);
+        const double dQ1 = A*(beta1/srs + 2.0*beta2 + 3.0*beta3*srs + 4.0*beta4*rs);
+        const double L = std::log(1.0 + 1.0/Q1);
+        const double eps = -2.0*A*(1.0 + alpha1*rs)*L;
+        const double deps = -2.0*A*alpha1*L + 2.0*A*(1.0 + alpha1*rs)*dQ1/(Q1*Q1 + Q1);
+
+        const double rho73 = c.rho[i]*c.rho[i]*c.r13[i];
+        const double y = ct*c.sigma[i]/rho73;
+        const double ex = std::exp(-eps/gamma);
+        const double a = bg/(ex - 1.0);
+        const double ay = a*y;
+        const double Dn = 1.0 + ay + ay*ay;
+        const double iDn2 = 1.0/(Dn*Dn);
+        const double R = y*(1.0 + ay)/Dn;
+        const double H = gamma*std::log(1.0 + bg*R);
+        const double dHdR = beta/(1.0 + bg*R);
+        const double dRdy = (1.0 + 2.0*ay)*iDn2;
+        const double dRda = -y*y*ay*(2.0 + ay)*iDn2;
+        const double dade = bg/gamma*ex/((ex - 1.0)*(ex - 1.0));
+        const double dHde = dHdR*dRda*dade;
+        const double dHdy = dHdR*dRdy;
+
+        c.e[i] += w*c.rho[i]*(eps + H);
+        c.vr[i] += w*(eps + H - rs/3.0*deps*(1.0 + dHde) - 7.0/3.0*y*dHdy);
+        c.vs[i] += w*ct*dHdy/(c.rho[i]*c.r13[i]);
+    }
+}
+
+/// Lee-Yang-Parr correlation in the closed-shell form of Miehlich et al.
+void lyp(chunk& c, const double w) {
+    const double a = 0.04918, b = 0.132, cc = 0.2533, d = 0.349;
+    const double CF = 0.3*cbrt3pi2*cbrt3pi2;
+    const double ab72 = a*b/72.0;
+    for (long i=0; i<c.n; ++i) {
+        const double rho = c.rho[i];
+        const double r = 1.0/c.r13[i];                          // rho^(-1/3)
+        const double r2 = r*r;
+        const double r5 = r2*r2*r;                              // rho^(-5/3)
+        const double P = 1.0/(1.0 + d*r);
+        const double E = std::exp(-cc*r);
+        const double delta = cc*r + d*r*P;
+        const double s = ab72*r5*P*E;                           // d e/d sigma without (3+7 delta)
+        const double C = s*c.sigma[i]*(3.0 + 7.0*delta);
+        const double irho3 = 1.0/(3.0*rho);
+
+        c.e[i] += w*(-a*P*rho - a*b*CF*P*E*rho + C);
+        c.vr[i] += w*(-a*(P + d*P*P*r/3.0)
+                - a*b*CF*P*E*(1.0 + (d*P*r + cc*r)/3.0)
+                + C*irho3*(-5.0 + d*P*r + cc*r)
+                - 7.0*s*c.sigma[i]*(cc + d*P*P)*r*irho3);
+        c.vs[i] += w*s*(3.0 + 7.0*delta);
+    }
+}
+
+/// evaluate all components of the functional on the chunk
+void evaluate(const functional& f, chunk& c) {
+    for (long i=0; i<c.n; ++i) c.e[i] = c.vr[i] = c.vs[i] = 0.0;
+    if (f.slater!=0.0) slater(c, f.slater);
+    if (f.vwn5!=0.0) vwn(c, f.vwn5, 0.0310907, 3.72744, 12.9352, -0.10498);
+    if (f.vwn_rpa!=0.0) vwn(c, f.vwn_rpa, 0.0310907, 13.0720, 42.7198, -0.409286);
+    if (f.b88!=0.0) b88(c, f.b88);
+    if (f.pbe_x!=0.0) pbe_x(c, f.pbe_x);
+    if (f.pbe_c!=0.0) pbe_c(c, f.pbe_c);
+    if (f.lyp!=0.0) lyp(c, f.lyp);
+}
+
+}
+
+
+bool functional::add_combination(const std::string& name, double& hf_coeff) {
+    if (name=="LDA") {
+        slater+=1.0; vwn5+=1.0;
+    } else if (name=="BLYP") {
+        b88+=1.0; lyp+=1.0;
+    } else if (name=="PBE") {
+        pbe_x+=1.0; pbe_c+=1.0;
+    } else if (name=="PBE0") {
+        pbe_x+=0.75; pbe_c+=1.0;
+        hf_coeff=0.25;
+    } else if (name=="B3LYP") {
+        // same composition as libxc's HYB_GGA_XC_B3LYP
+        slater+=0.08; b88+=0.72; vwn_rpa+=0.19; lyp+=0.81;
+        hf_coeff=0.2;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool functional::add_component(const std::string& name, const double factor) {
+    if (name=="LDA_X") slater+=factor;
+    else if (name=="LDA_C_VWN") vwn5+=factor;
+    else if (name=="LDA_C_VWN_RPA") vwn_rpa+=factor;
+    else if (name=="GGA_X_B88") b88+=factor;
+    else if (name=="GGA_X_PBE") pbe_x+=factor;
+    else if (name=="GGA_C_PBE") pbe_c+=factor;
+    else if (name=="GGA_C_LYP") lyp+=factor;
+    else return false;
+    return true;
+}
+
+void functional::print() const {
+    const std::vector<std::pair<std::string,double> > components={
+        {"LDA_X",slater},{"LDA_C_VWN",vwn5},{"LDA_C_VWN_RPA",vwn_rpa},
+        {"GGA_X_B88",b88},{"GGA_X_PBE",pbe_x},{"GGA_C_PBE",pbe_c},{"GGA_C_LYP",lyp}};
+    for (const auto& c : components) {
+        if (c.second!=0.0) printf(" %4.3f %s (native)\n",c.second,c.first.c_str());
+    }
+}
+
+
+bool restricted_kernel(const functional& f, const long np,
+        const double rhotol, const double rhomin,
+        const double* MADNESS_RESTRICT rhoa, const double* MADNESS_RESTRICT chiaa,
+        const double* const* zeta,
+        double* MADNESS_RESTRICT exc, double* MADNESS_RESTRICT vrho, double* const* vsig) {
+
+    const bool gga = f.is_gga();
+    MADNESS_ASSERT((not gga) or (chiaa and zeta));
+    chunk c;
+    double nancheck = 0.0;
+
+    for (long i0=0; i0<np; i0+=chunksize) {
+        c.n = std::min(chunksize, np-i0);
+        const long n = c.n;
+
+        // munged density and sigma, cf. make_libxc_args
+        for (long i=0; i<n; ++i) {
+            const double r = 2.0*rhoa[i0+i];            // full dens is twice alpha dens
+            const double rho = (r <= rhotol) ? rhomin : r;
+            c.mask[i] = (rho > dens_threshold) ? 1.0 : 0.0;
+            c.rho[i] = std::max(rho, dens_threshold);
+            c.sigma[i] = 1.e-14;
+        }
+        for (long i=0; i<n; ++i) c.r13[i] = std::cbrt(c.rho[i]);
+        if (gga) {
+            for (long i=0; i<n; ++i) {
+                c.sigma[i] = std::max(1.e-14, c.rho[i]*c.rho[i]*chiaa[i0+i]);
+            }
+        }
+
+        evaluate(f, c);
+
+        if (exc) {
+            for (long i=0; i<n; ++i) {
+                exc[i0+i] = c.mask[i]*c.e[i];
+                nancheck += exc[i0+i];
+            }
+        }
+        if (vrho) {
+            for (long i=0; i<n; ++i) {
+                vrho[i0+i] = c.mask[i]*c.vr[i];
+                nancheck += vrho[i0+i];
+            }
+        }
+        if (gga and vsig) {
+            // 2 d e/d sigma grad rho, with grad rho = rho grad zeta
+            for (int d=0; d<3; ++d) {
+                const double* MADNESS_RESTRICT z = zeta[d];
+                double* MADNESS_RESTRICT v = vsig[d];
+                for (long i=0; i<n; ++i) {
+                    v[i0+i] = 2.0*c.mask[i]*c.vs[i]*c.rho[i]*z[i0+i];
+                    nancheck += v[i0+i];
+                }
+            }
+        }
+    }
+    return not std::isnan(nancheck);
+}
+
+
+Tensor<double> exc(const functional& f, const std::vector< Tensor<double> >& t,
+        const double rhotol, const double rhomin) {
+    typedef XCfunctional xcf;
+    const long np = t[xcf::enum_rhoa].size();
+    Tensor<double> result(3L, t[xcf::enum_rhoa].dims(), false);
+
+    const double* zeta[3]={nullptr,nullptr,nullptr};
+    const double* chi=nullptr;
+    if (f.is_gga()) {
+        chi = t[xcf::enum_chi_aa].ptr();
+        zeta[0] = t[xcf::enum_zetaa_x].ptr();
+        zeta[1] = t[xcf::enum_zetaa_y].ptr();
+        zeta[2] = t[xcf::enum_zetaa_z].ptr();
+    }
+    bool ok = restricted_kernel(f, np, rhotol, rhomin, t[xcf::enum_rhoa].ptr(), chi, zeta,
+            result.ptr(), nullptr, nullptr);
+    if (not ok) MADNESS_EXCEPTION("NaN in xc_native::exc",1);
+    return result;
+}
+
+
+std::vector< Tensor<double> > vxc(const functional& f, const std::vector< Tensor<double> >& t,
+        const double rhotol, const double rhomin) {
+    typedef XCfunctional xcf;
+    const long np = t[xcf::enum_rhoa].size();
+    const bool gga = f.is_gga();
+
+    std::vector< Tensor<double> > result(gga ? 4 : 1);
+    for (Tensor<double>& r : result) r = Tensor<double>(3L, t[xcf::enum_rhoa].dims(), false);
+
+    const double* zeta[3]={nullptr,nullptr,nullptr};
+    double* vsig[3]={nullptr,nullptr,nullptr};
+    const double* chi=nullptr;
+    if (gga) {
+        chi = t[xcf::enum_chi_aa].ptr();
+        zeta[0] = t[xcf::enum_zetaa_x].ptr();
+        zeta[1] = t[xcf::enum_zetaa_y].ptr();
+        zeta[2] = t[xcf::enum_zetaa_z].ptr();
+        for (int d=0; d<3; ++d) vsig[d] = result[d+1].ptr();
+    }
+    bool ok = restricted_kernel(f, np, rhotol, rhomin, t[xcf::enum_rhoa].ptr(), chi, zeta,
+            nullptr, result[0].ptr(), vsig);
+    if (not ok) MADNESS_EXCEPTION("NaN in xc_native::vxc",1);
+    return result;
+}
+
+}
+}
@@ -0,0 +1,93 @@
+#ifndef MADNESS_CHEM_XCFUNCTIONAL_NATIVE_H__INCLUDED
+#define MADNESS_CHEM_XCFUNCTIONAL_NATIVE_H__INCLUDED
+
+/// \file chem/xcfunctional_native.h
+/// \brief Built-in LDA/GGA exchange-correlation kernels
+/// \ingroup chemistry
+
+#include <madness/tensor/tensor.h>
+#include <string>
+#include <vector>
+
+namespace madness {
+namespace xc_native {
+
+/// Weights of the built-in functional components
+
+/// The functionals we run most (LDA, BLYP, PBE, PBE0, B3LYP) are linear
+/// combinations of a handful of components, which are evaluated here without
+/// the detour through libxc. Only spin-restricted densities are supported by
+/// the GGA kernels.
+struct functional {
+    double slater=0.0;      ///< Slater exchange (LDA_X)
+    double vwn5=0.0;        ///< VWN-5 correlation (LDA_C_VWN)
+    double vwn_rpa=0.0;     ///< VWN-RPA correlation (LDA_C_VWN_RPA), used in B3LYP
+    double b88=0.0;         ///< Becke 88 exchange, including the LDA part (GGA_X_B88)
+    double pbe_x=0.0;       ///< PBE exchange (GGA_X_PBE)
+    double pbe_c=0.0;       ///< PBE correlation (GGA_C_PBE)
+    double lyp=0.0;         ///< Lee-Yang-Parr correlation (GGA_C_LYP)
+
+    /// add a named combination (LDA, BLYP, PBE, PBE0, B3LYP)
+
+    /// @param[in]  name        upper-case name of the combination
+    /// @param[out] hf_coeff    the amount of HF exchange in the combination
+    /// @return false if the name is not known
+    bool add_combination(const std::string& name, double& hf_coeff);
+
+    /// add a single component with its libxc name (e.g. GGA_X_B88)
+
+    /// @return false if the component is not available natively
+    bool add_component(const std::string& name, const double factor);
+
+    /// true if no component has been added
+    bool empty() const {
+        return (slater==0.0) and (vwn5==0.0) and (vwn_rpa==0.0) and (not is_gga());
+    }
+
+    /// true if any of the components needs the density gradient
+    bool is_gga() const {
+        return (b88!=0.0) or (pbe_x!=0.0) or (pbe_c!=0.0) or (lyp!=0.0);
+    }
+
+    /// true if this is plain Slater + VWN-5, the only spin-polarized option
+    bool is_svwn5() const {
+        return (slater==1.0) and (vwn5==1.0) and (vwn_rpa==0.0) and (not is_gga());
+    }
+
+    /// print the components with their weights
+    void print() const;
+};
+
+/// Fused evaluation of energy density and potential for spin-restricted densities
+
+/// The munged density, the reduced gradient sigma and the density gradient are
+/// built from the xc_args on the fly, in cache-sized chunks of points, and all
+/// components of the functional are accumulated in a single pass. Any of the
+/// output pointers may be null.
+/// @param[in]  f       the functional
+/// @param[in]  np      number of points
+/// @param[in]  rhotol  density below which rho is set to rhomin
+/// @param[in]  rhomin  see rhotol
+/// @param[in]  rhoa    the alpha density, the total density is 2*rhoa
+/// @param[in]  chiaa   \f$ |\nabla\zeta|^2 \f$ (GGA only)
+/// @param[in]  zeta    \f$ \nabla\zeta \f$, three pointers (GGA only)
+/// @param[out] exc     energy density per volume
+/// @param[out] vrho    \f$ \partial\epsilon/\partial\rho \f$
+/// @param[out] vsig    \f$ 2\partial\epsilon/\partial\sigma\nabla\rho \f$, three pointers (GGA only)
+/// @return false if a NaN was encountered
+bool restricted_kernel(const functional& f, const long np,
+        const double rhotol, const double rhomin,
+        const double* rhoa, const double* chiaa, const double* const* zeta,
+        double* exc, double* vrho, double* const* vsig);
+
+/// Computes the energy density from the xc_args, see XCfunctional::exc
+Tensor<double> exc(const functional& f, const std::vector< Tensor<double> >& xc_args,
+        const double rhotol, const double rhomin);
+
+/// Computes the potential from the xc_args, see XCfunctional::vxc
+std::vector< Tensor<double> > vxc(const functional& f, const std::vector< Tensor<double> >& xc_args,
+        const double rhotol, const double rhomin);
+
+}
+}
+#endif
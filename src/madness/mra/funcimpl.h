@@ -42,6 +42,7 @@
 #include <madness/misc/misc.h>
 #include <madness/tensor/tensor.h>
 #include <madness/tensor/gentensor.h>
+#include <madness/tensor/fixedtensor.h>
 
 #include <madness/mra/function_common_data.h>
 #include <madness/mra/indexit.h>
@@ -139,6 +140,10 @@ namespace madness {
 
     public:
         typedef WorldContainer<Key<NDIM> , FunctionNode<T, NDIM> > dcT; ///< Type of container holding the nodes
+
+        /// Rank of the uncompressed batch of low-rank summands in accumulate
+        static constexpr long accumulation_batch_rank=64;
+
         /// Default constructor makes node without coeff or children
         FunctionNode() :
             _coeffs(), _norm_tree(1e300), _has_children(false) {
@@ -404,7 +409,18 @@ namespace madness {
         /// Accumulate inplace and if necessary connect node to parent
         void accumulate(const coeffT& t, const typename FunctionNode<T,NDIM>::dcT& c,
                           const Key<NDIM>& key, const TensorArgs& args) {
-            if (has_coeff()) {
+            if (has_coeff() and coeff().is_svd_tensor()) {
+                // collect the summands by concatenation and compress them in
+                // batches into the buffer, instead of an SVD per summand
+                coeff()+=t;
+                if (coeff().rank()>std::max(accumulation_batch_rank,buffer.rank())) {
+                    if (buffer.has_data()) buffer+=coeff();
+                    else buffer=coeff();
+                    buffer.reduce_rank_randomized(args.thresh);
+                    coeff()=coeffT();
+                }
+
+            } else if (has_coeff()) {
                 coeff().add_SVD(t,args.thresh);
                 if (buffer.rank()<coeff().rank()) {
                     if (buffer.has_data()) {
@@ -431,7 +447,11 @@ namespace madness {
         }
 
         void consolidate_buffer(const TensorArgs& args) {
-            if ((coeff().has_data()) and (buffer.has_data())) {
+            if (coeff().has_data() and coeff().is_svd_tensor()) {
+                // coeff holds an uncompressed batch, see accumulate
+                if (buffer.has_data()) coeff()+=buffer;
+                coeff().reduce_rank_randomized(args.thresh);
+            } else if ((coeff().has_data()) and (buffer.has_data())) {
                 coeff().add_SVD(buffer,args.thresh);
             } else if (buffer.has_data()) {
                 coeff()=buffer;
@@ -1682,6 +1702,7 @@ namespace madness {
         GenTensor<Q> coeffs2values(const keyT& key, const GenTensor<Q>& coeff) const {
             // PROFILE_MEMBER_FUNC(FunctionImpl); // Too fine grain for routine profiling
             double scale = pow(2.0,0.5*NDIM*key.level())/sqrt(FunctionDefaults<NDIM>::get_cell_volume());
+            if (coeff.is_full_tensor()) return GenTensor<Q>(fixed_transform(coeff.get_tensor(),cdata.quad_phit).scale(scale));
             return transform(coeff,cdata.quad_phit).scale(scale);
         }
 
@@ -1808,13 +1829,14 @@ namespace madness {
         Tensor<Q> coeffs2values(const keyT& key, const Tensor<Q>& coeff) const {
             // PROFILE_MEMBER_FUNC(FunctionImpl); // Too fine grain for routine profiling
             double scale = pow(2.0,0.5*NDIM*key.level())/sqrt(FunctionDefaults<NDIM>::get_cell_volume());
-            return transform(coeff,cdata.quad_phit).scale(scale);
+            return fixed_transform(coeff,cdata.quad_phit).scale(scale);
         }
 
         template <typename Q>
         GenTensor<Q> values2coeffs(const keyT& key, const GenTensor<Q>& values) const {
             // PROFILE_MEMBER_FUNC(FunctionImpl); // Too fine grain for routine profiling
             double scale = pow(0.5,0.5*NDIM*key.level())*sqrt(FunctionDefaults<NDIM>::get_cell_volume());
+            if (values.is_full_tensor()) return GenTensor<Q>(fixed_transform(values.get_tensor(),cdata.quad_phiw).scale(scale));
             return transform(values,cdata.quad_phiw).scale(scale);
         }
 
@@ -1822,7 +1844,7 @@ namespace madness {
         Tensor<Q> values2coeffs(const keyT& key, const Tensor<Q>& values) const {
             // PROFILE_MEMBER_FUNC(FunctionImpl); // Too fine grain for routine profiling
             double scale = pow(0.5,0.5*NDIM*key.level())*sqrt(FunctionDefaults<NDIM>::get_cell_volume());
-            return transform(values,cdata.quad_phiw).scale(scale);
+            return fixed_transform(values,cdata.quad_phiw).scale(scale);
         }
 
         /// Compute the function values for multiplication
@@ -1895,7 +1917,7 @@ namespace madness {
             Tensor<T> tcube(cdata.vk,false);
             TERNARY_OPTIMIZED_ITERATOR(T, tcube, L, lcube, R, rcube, *_p0 = *_p1 * *_p2;);
             double scale = pow(0.5,0.5*NDIM*key.level())*sqrt(FunctionDefaults<NDIM>::get_cell_volume());
-            tcube = transform(tcube,cdata.quad_phiw).scale(scale);
+            tcube = fixed_transform(tcube,cdata.quad_phiw).scale(scale);
             coeffs.replace(key, nodeT(coeffT(tcube,targs),false));
         }
 
@@ -1947,7 +1969,7 @@ namespace madness {
 	  Tensor<T> tcube(cdata.vk,false);
 	  op(key, tcube, lcube, rcube);
 	  double scale = pow(0.5,0.5*NDIM*key.level())*sqrt(FunctionDefaults<NDIM>::get_cell_volume());
-	  tcube = transform(tcube,cdata.quad_phiw).scale(scale);
+	  tcube = fixed_transform(tcube,cdata.quad_phiw).scale(scale);
 	  coeffs.replace(key, nodeT(coeffT(tcube,targs),false));
 	}
 
@@ -4648,8 +4670,16 @@ namespace madness {
             coeffT result;
             if (2*OPDIM==NDIM) result= op->apply2_lowdim(args.key, args.d, coeff,
                     args.tol/args.fac/args.cnorm, args.tol/args.fac);
-            if (OPDIM==NDIM) result = op->apply2(args.key, args.d, coeff,
-                    args.tol/args.fac/args.cnorm, args.tol/args.fac);
+            if (OPDIM==NDIM) {
+#if HAVE_GENTENSOR
+                // keep source, operator and result in tensor train form
+                if (coeff.is_tensortrain()) result = op->apply_tt(args.key, args.d, coeff,
+                        args.tol/args.fac/args.cnorm, args.tol/args.fac);
+                else
+#endif
+                result = op->apply2(args.key, args.d, coeff,
+                        args.tol/args.fac/args.cnorm, args.tol/args.fac);
+            }
 
             const double result_norm=result.svd_normf();
 
@@ -4724,6 +4754,53 @@ namespace madness {
 
             const std::vector<opkeyT>& disp = op->get_disp(key.level()); // list of displacements sorted in orer of increasing distance
             const std::vector<bool> is_periodic(NDIM,false); // Periodic sum is already done when making rnlp
+
+            // in the NS form the operator norms are tabulated by displacement,
+            // so whole shells can be screened with their largest norm
+            if (not op->modified()) {
+                const typename opT::NormTable& table = op->get_norm_table(key.level());
+                const double tol = truncate_tol(thresh, key);
+                const Key<NDIM-opdim> nullkey(key.level());
+                std::size_t nchecked=0, nskipped=0, napplied=0;
+                int ndone=1;
+                for (std::size_t ishell=0; ishell<table.shell_max.size(); ++ishell) {
+                    const std::size_t begin=table.shell_begin[ishell], end=table.shell_begin[ishell+1];
+                    if (ndone==0 && disp[begin].distsq()>1) break;   // same rule as below
+                    if (cnorm*table.tail_max[ishell] <= tol/fac) {
+                        nskipped+=disp.size()-begin;
+                        break;
+                    }
+                    ndone=0;
+                    if (cnorm*table.shell_max[ishell] <= tol/fac) {
+                        nskipped+=end-begin;
+                        continue;
+                    }
+
+                    for (std::size_t i=begin; i<end; ++i) {
+                        keyT d;
+                        if (op->particle()==1) d=disp[i].merge_with(nullkey);
+                        if (op->particle()==2) d=nullkey.merge_with(disp[i]);
+
+                        keyT dest = neighbor(key, d, is_periodic);
+                        if (not dest.is_valid()) continue;
+                        ++nchecked;
+                        if (cnorm*table.norm[i] > tol/fac) {
+                            ndone++;
+                            napplied++;
+                            tensorT result = op->apply(source, disp[i], c, tol/fac/cnorm);
+                            if (result.normf() > 0.3*tol/fac) {
+                                if (coeffs.is_local(dest))
+                                    coeffs.send(dest, &nodeT::accumulate2, result, coeffs, dest);
+                                else
+                                    coeffs.task(dest, &nodeT::accumulate2, result, coeffs, dest);
+                            }
+                        }
+                    }
+                }
+                op->add_screening_statistics(nchecked, nskipped, napplied);
+                return;
+            }
+
 	    int ndone=1;	// Counts #done at each distance
 	    uint64_t distsq = 99999999999999; 
             for (typename std::vector<opkeyT>::const_iterator it=disp.begin(); it != disp.end(); ++it) {
@@ -4836,10 +4913,17 @@ namespace madness {
             // for partial application (exchange operator) it's more efficient to
             // do SVD tensors instead of tensortrains, because addition in apply
             // can be done in full form for the specific particle
-            coeffT coeff_SVD=coeff.convert(TensorArgs(-1.0,TT_2D));
+            // for full application tensortrains stay tensortrains
+            const bool use_tt=(2*opdim!=NDIM) and coeff.is_tensortrain() and (not op->modified());
+            coeffT coeff_SVD;
+            if (use_tt) {
+                coeff_SVD=coeff;
+            } else {
+                coeff_SVD=coeff.convert(TensorArgs(-1.0,TT_2D));
 #ifdef HAVE_GENTENSOR
-            coeff_SVD.get_svdtensor().orthonormalize(tol*GenTensor<T>::fac_reduce());
+                coeff_SVD.get_svdtensor().orthonormalize(tol*GenTensor<T>::fac_reduce());
 #endif
+            }
 
             const std::vector<opkeyT>& disp = op->get_disp(key.level());
             const std::vector<bool> is_periodic(NDIM,false); // Periodic sum is already done when making rnlp
@@ -4892,7 +4976,8 @@ namespace madness {
                                 if (not coeff_full.has_data()) coeff_full=coeff.full_tensor_copy();
                                 norm=do_apply_kernel2(op, coeff_full,args,apply_targs);
                             } else {
-                                if (2*opdim==NDIM) {    // apply operator on one particle only
+                                // apply operator on one particle only, or modified operator on tensortrains
+                                if ((2*opdim==NDIM) or (coeff.is_tensortrain() and (not use_tt))) {
                                     norm=do_apply_kernel3(op,coeff_SVD,args,apply_targs);
                                 } else {
                                     norm=do_apply_kernel3(op,coeff,args,apply_targs);
@@ -10,6 +10,8 @@
 #include<string>
 #include<iomanip>
 #include<sstream>
+#include<map>
+#include<mutex>
 #include<madness/world/madness_exception.h>
 
 
@@ -183,6 +185,95 @@ public:
     }
 };
 
+/// measured cost of previously executed macrotasks, keyed by task type and batch
+
+/// The cost model is filled by the MacroTaskQ scheduler (on universe rank 0) whenever a task
+/// completes, and is queried by the partitioner to assign priorities to the tasks of the next
+/// invocation of the same task type (e.g. in the next SCF iteration). Batches that have not been
+/// measured yet are estimated from the average cost per input element of their task type.
+/// Note that the measurements are only available on the process holding the scheduler.
+class MacroTaskCostModel {
+public:
+    struct Cost {
+        double time=0.0;        ///< wall time of a task in s (moving average over invocations)
+        double memory=0.0;      ///< memory of the task's result in GByte (moving average)
+        long ncalls=0;          ///< number of measurements
+    };
+
+    /// weight of the latest measurement in the moving average
+    double mixing=0.5;
+
+    /// the process-wide cost model shared by all MacroTaskQs
+    static MacroTaskCostModel& get_instance() {
+        static MacroTaskCostModel instance;
+        return instance;
+    }
+
+    /// record the measured cost of a task
+    void record(const std::string& tasktype, const std::string& batch, const double time,
+                const double memory, const long input_size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Cost& c=costs[std::make_pair(tasktype,batch)];
+        if (c.ncalls==0) {
+            c.time=time;
+            c.memory=memory;
+        } else {
+            c.time=mixing*time + (1.0-mixing)*c.time;
+            c.memory=mixing*memory + (1.0-mixing)*c.memory;
+        }
+        c.ncalls++;
+        TypeAverage& avg=type_averages[tasktype];
+        avg.time+=time;
+        avg.input_size+=std::max(1l,input_size);
+    }
+
+    /// check if any measurement of this task type exists
+    bool has_cost(const std::string& tasktype) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return type_averages.count(tasktype)>0;
+    }
+
+    /// estimated wall time of a batch; measured if available, extrapolated from its task type otherwise
+
+    /// @return the estimated time, or a negative number if nothing is known about this task type
+    double estimate_time(const std::string& tasktype, const std::string& batch, const long input_size) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it=costs.find(std::make_pair(tasktype,batch));
+        if (it!=costs.end()) return it->second.time;
+        auto it2=type_averages.find(tasktype);
+        if (it2==type_averages.end()) return -1.0;
+        return it2->second.time/it2->second.input_size * std::max(1l,input_size);
+    }
+
+    /// return the measured cost of a batch (zero cost if it has not been measured)
+    Cost get_cost(const std::string& tasktype, const std::string& batch) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it=costs.find(std::make_pair(tasktype,batch));
+        return (it==costs.end()) ? Cost() : it->second;
+    }
+
+    /// forget all measurements
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        costs.clear();
+        type_averages.clear();
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return costs.size();
+    }
+
+private:
+    struct TypeAverage {
+        double time=0.0;
+        long input_size=0;
+    };
+    mutable std::mutex mutex;
+    std::map<std::pair<std::string,std::string>,Cost> costs;
+    std::map<std::string,TypeAverage> type_averages;
+};
+
 /// partition one (two) vectors into 1D (2D) batches.
 
 /// derive from this class and override the \it{do_partitioning} method if you want to implement
@@ -197,6 +288,8 @@ public:
     std::size_t nsubworld=1;                ///< number of worlds (try to have enough batches for all worlds)
     std::string policy = "guided";          ///< how to partition the batches
     std::size_t dimension = 1;              ///< partition one or two vectors
+    std::string tasktype = "";              ///< task type for looking up measured costs
+    bool use_cost_model = true;             ///< prioritize by measured costs of previous invocations
 
     MacroTaskPartitioner() {}
 
@@ -222,6 +315,14 @@ public:
         max_batch_size=n;
         return *this;
     }
+    MacroTaskPartitioner& set_tasktype(const std::string& n) {
+        tasktype=n;
+        return *this;
+    }
+    MacroTaskPartitioner& set_use_cost_model(const bool n) {
+        use_cost_model=n;
+        return *this;
+    }
 
     /// this will be called by MacroTask, it will *always* partition first (and possibly second) vector of arguments
     template<typename tupleT>
@@ -242,7 +343,23 @@ public:
             MADNESS_EXCEPTION(msg.c_str(),1);
         }
 
-        return do_partitioning(vsize1,vsize2,policy);
+        partitionT partition=do_partitioning(vsize1,vsize2,policy);
+        if (use_cost_model) apply_cost_model(partition,MacroTaskCostModel::get_instance());
+        return partition;
+    }
+
+    /// replace the priorities of the batches by their measured or estimated costs
+
+    /// this enables longest-processing-time-first scheduling in the MacroTaskQ. The priorities
+    /// are left untouched if there are no measurements for this task type.
+    void apply_cost_model(partitionT& partition, const MacroTaskCostModel& costs) const {
+        if (tasktype.empty() or (not costs.has_cost(tasktype))) return;
+        for (auto& batch_prio : partition) {
+            std::stringstream ss;
+            ss << batch_prio.first;
+            double time=costs.estimate_time(tasktype,ss.str(),batch_prio.first.size_of_input());
+            if (time>=0.0) batch_prio.second=time;
+        }
     }
 
     /// override this if you want your own partitioning
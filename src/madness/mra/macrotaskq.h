@@ -17,7 +17,12 @@
  The user-defined macrotask is derived from MacroTaskIntermediate and must implement the run()
  method. A heterogeneous task queue is possible.
 
- TODO: priority q
+ Tasks are scheduled longest-processing-time first: each completed task reports its measured
+ wall time and output size to the scheduler, which records it in the MacroTaskCostModel. The
+ partitioner uses these measurements to assign priorities in the next invocation of the same
+ task type, so long-running batches are started first and subworlds run out of work at about
+ the same time. A scheduling report shows the utilization of each subworld.
+
  TODO: task submission from inside task (serialize task instead of replicate)
  TODO: update documentation
  TODO: consider serializing task member variables
@@ -46,6 +51,7 @@ public:
 
 	double priority=1.0;
 	enum Status {Running, Waiting, Complete, Unknown} stat=Unknown;
+	double memory=0.0;			///< size of the task's output in GByte, set by run()
 
 	void set_complete() {stat=Complete;}
 	void set_running() {stat=Running;}
@@ -72,6 +78,11 @@ public:
 
     double get_priority() const {return priority;}
 
+    /// the task type and batch identify this task in the MacroTaskCostModel
+    virtual std::string get_name() const {return typeid(*this).name();}
+    virtual std::string get_batch_string() const {return "";}
+    virtual long get_input_size() const {return 1;}
+
     friend std::ostream& operator<<(std::ostream& os, const MacroTaskBase::Status s) {
     	if (s==MacroTaskBase::Status::Running) os << "Running";
     	if (s==MacroTaskBase::Status::Waiting) os << "Waiting";
@@ -109,6 +120,10 @@ class MacroTaskQ : public WorldObject< MacroTaskQ> {
 	std::mutex taskq_mutex;
 	long printlevel=0;
 	long nsubworld=1;
+	std::string scheduling_policy="lpt";
+	std::vector<double> subworld_busy_time;	///< wall time spent in tasks per subworld (last run)
+	std::vector<long> subworld_ntask;		///< number of tasks per subworld (last run)
+	double elapsed_time=0.0;				///< wall time of the last run
     std::shared_ptr< WorldDCPmapInterface< Key<1> > > pmap1;
     std::shared_ptr< WorldDCPmapInterface< Key<2> > > pmap2;
     std::shared_ptr< WorldDCPmapInterface< Key<3> > > pmap3;
@@ -126,6 +141,14 @@ public:
 	long get_nsubworld() const {return nsubworld;}
 	void set_printlevel(const long p) {printlevel=p;}
 
+	/// set the order in which waiting tasks are handed out to the subworlds
+
+	/// "lpt": longest processing time (highest priority) first, "fifo": in order of submission
+	void set_scheduling_policy(const std::string& policy) {
+		MADNESS_CHECK(policy=="lpt" or policy=="fifo");
+		scheduling_policy=policy;
+	}
+
     /// create an empty taskq and initialize the subworlds
 	MacroTaskQ(World& universe, int nworld, const long printlevel=0)
 	  : WorldObject<MacroTaskQ>(universe)
@@ -176,13 +199,17 @@ public:
         set_pmap(get_subworld());
 
         double cpu00=cpu_time();
+        double wall00=wall_time();
 
 		World& subworld=get_subworld();
 //		if (printdebug()) print("I am subworld",subworld.id());
 		double tasktime=0.0;
+		double busytime=0.0;
+		long ntask=0;
 		while (true){
 			long element=get_scheduled_task_number(subworld);
             double cpu0=cpu_time();
+            double wall0=wall_time();
 			if (element<0) break;
 			std::shared_ptr<MacroTaskBase> task=taskq[element];
             if (printdebug()) print("starting task no",element, "in subworld",subworld.id(),"at time",wall_time());
@@ -190,8 +217,11 @@ public:
 			task->run(subworld,cloud, taskq);
 
 			double cpu1=cpu_time();
-            set_complete(element);
+			double wall1=wall_time();
+            if (subworld.rank()==0) set_complete(element,wall1-wall0,task->memory);
 			tasktime+=(cpu1-cpu0);
+			busytime+=(wall1-wall0);
+			ntask++;
 			if (subworld.rank()==0 and printlevel>=3) printf("completed task %3ld after %6.1fs at time %6.1fs\n",element,cpu1-cpu0,wall_time());
 
 		}
@@ -199,16 +229,19 @@ public:
 		universe.gop.fence();
 		universe.gop.sum(tasktime);
         double cpu11=cpu_time();
+        gather_scheduling_statistics(subworld,busytime,ntask,wall_time()-wall00);
         if (printlevel>=3) cloud.print_timings(universe);
         if (printtimings()) {
             printf("completed taskqueue after    %4.1fs at time %4.1fs\n", cpu11 - cpu00, wall_time());
             printf(" total cpu time / per world  %4.1fs %4.1fs\n", tasktime, tasktime / universe.size());
+            print_scheduling_report();
         }
 
 		// cleanup task-persistent input data
 		for (auto& task : taskq) task->cleanup();
 		cloud.clear_cache(subworld);
 		subworld.gop.fence();
+		cloud.clear_shared_records();
         subworld.gop.fence();
         universe.gop.fence();
         FunctionDefaults<1>::set_pmap(pmap1);
@@ -238,7 +271,47 @@ public:
         universe.gop.fence();
     }
 
+    /// print the number of tasks, busy time and utilization of each subworld in the last run
+    void print_scheduling_report() const {
+        if (universe.rank()!=0) return;
+        print("\nscheduling report, policy:",scheduling_policy);
+        print(" subworld   #tasks   busy time   utilization");
+        double total=0.0;
+        for (std::size_t i=0; i<subworld_busy_time.size(); ++i) {
+            double util=(elapsed_time>0.0) ? subworld_busy_time[i]/elapsed_time : 0.0;
+            total+=util;
+            printf("%9lu %8ld %10.2fs %12.1f%%\n",i,subworld_ntask[i],subworld_busy_time[i],util*100.0);
+        }
+        if (subworld_busy_time.size()>0)
+            printf(" average utilization %5.1f%% after %6.2fs\n",total/subworld_busy_time.size()*100.0,elapsed_time);
+    }
+
+    /// utilization (busy time/elapsed time) of each subworld in the last run
+    std::vector<double> get_subworld_utilization() const {
+        std::vector<double> util(subworld_busy_time.size(),0.0);
+        if (elapsed_time>0.0) {
+            for (std::size_t i=0; i<util.size(); ++i) util[i]=subworld_busy_time[i]/elapsed_time;
+        }
+        return util;
+    }
+
 private:
+    /// collect busy time and number of tasks of all subworlds in the universe
+    void gather_scheduling_statistics(World& subworld, const double busytime, const long ntask,
+                                      const double elapsed) {
+        const long color=universe.rank() % nsubworld;
+        subworld_busy_time=std::vector<double>(nsubworld,0.0);
+        subworld_ntask=std::vector<long>(nsubworld,0l);
+        if (subworld.rank()==0) {
+            subworld_busy_time[color]=busytime;
+            subworld_ntask[color]=ntask;
+        }
+        universe.gop.sum(subworld_busy_time.data(),nsubworld);
+        universe.gop.sum(subworld_ntask.data(),nsubworld);
+        elapsed_time=elapsed;
+        universe.gop.max(elapsed_time);
+    }
+
 	void add_replicated_task(const std::shared_ptr<MacroTaskBase>& task) {
 		taskq.push_back(task);
 	}
@@ -260,8 +333,13 @@ private:
 		MADNESS_ASSERT(universe.rank()==0);
 		std::lock_guard<std::mutex> lock(taskq_mutex);
 
-		auto is_Waiting = [](const std::shared_ptr<MacroTaskBase>& mtb_ptr) {return mtb_ptr->is_waiting();};
-		auto it=std::find_if(taskq.begin(),taskq.end(),is_Waiting);
+		// fifo: first waiting task; lpt: waiting task with the highest priority (first of equals)
+		auto it=taskq.end();
+		for (auto t=taskq.begin(); t!=taskq.end(); ++t) {
+			if (not t->get()->is_waiting()) continue;
+			if (it==taskq.end() or t->get()->get_priority()>it->get()->get_priority()) it=t;
+			if (scheduling_policy=="fifo") break;
+		}
 		if (it!=taskq.end()) {
 			it->get()->set_running();
 			long element=it-taskq.begin();
@@ -272,14 +350,17 @@ private:
 	}
 
 	/// scheduler is located on rank==0
-	void set_complete(const long task_number) const {
-		this->task(ProcessID(0), &MacroTaskQ::set_complete_local, task_number);
+	void set_complete(const long task_number, const double time, const double memory) const {
+		this->task(ProcessID(0), &MacroTaskQ::set_complete_local, task_number, time, memory);
 	}
 
-	/// scheduler is located on rank==0
-	void set_complete_local(const long task_number) const {
+	/// scheduler is located on rank==0, record the measured cost for the next invocation
+	void set_complete_local(const long task_number, const double time, const double memory) const {
 		MADNESS_ASSERT(universe.rank()==0);
-		taskq[task_number]->set_complete();
+		const auto& task=taskq[task_number];
+		task->set_complete();
+		MacroTaskCostModel::get_instance().record(task->get_name(),task->get_batch_string(),
+				time,memory,task->get_input_size());
 	}
 
 public:
@@ -345,6 +426,7 @@ public:
         auto partitioner=task.partitioner;
         if (not partitioner) partitioner.reset(new MacroTaskPartitioner);
         partitioner->set_nsubworld(world.size());
+        partitioner->set_tasktype(typeid(task).name());
         partitionT partition = partitioner->partition_tasks(argtuple);
 
         // store input and output: output being a pointer to a universe function (vector)
@@ -406,6 +488,20 @@ private:
             print("this is task",typeid(task).name(),"with batch", task.batch,"priority",this->get_priority());
         }
 
+        std::string get_name() const override {
+            return typeid(task).name();
+        }
+
+        std::string get_batch_string() const override {
+            std::stringstream ss;
+            ss << task.batch;
+            return ss.str();
+        }
+
+        long get_input_size() const override {
+            return task.batch.size_of_input();
+        }
+
         virtual void print_me_as_table(std::string s="") const {
             std::stringstream ss;
             std::string name=typeid(task).name();
@@ -430,6 +526,11 @@ private:
             const argtupleT batched_argtuple = task.batch.template copy_input_batch(argtuple);
 
             resultT result_tmp = std::apply(task, batched_argtuple);
+            if constexpr (is_madness_function<resultT>::value) {
+                this->memory=get_size(result_tmp);
+            } else {
+                this->memory=get_size(subworld,result_tmp);
+            }
 
             resultT result = get_output(subworld, cloud, argtuple);       // lives in the universe
             if constexpr (is_madness_function<resultT>::value) {
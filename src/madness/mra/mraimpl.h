@@ -2813,12 +2813,13 @@ namespace madness {
         MADNESS_ASSERT(cdata.npt == cdata.k); // only necessary due to use of fast transform
         tensorT fval(cdata.vq,false); // this will be the returned result
         tensorT work(cdata.vk,false); // initially evaluate the function in here
-        tensorT workq(cdata.vq,false); // initially evaluate the function in here
 
         // compute the values of the functor at the quadrature points and scale appropriately
         madness::fcube(key,*functor,cdata.quad_x,work);
         work.scale(sqrt(FunctionDefaults<NDIM>::get_cell_volume()*pow(0.5,double(NDIM*key.level()))));
         //return transform(work,cdata.quad_phiw);
+        if (fixed_fast_transform(work,cdata.quad_phiw,fval)) return fval;
+        tensorT workq(cdata.vq,false);
         return fast_transform(work,cdata.quad_phiw,fval,workq);
     }
 
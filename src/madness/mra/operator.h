@@ -39,6 +39,7 @@
 
 #include <type_traits>
 #include <limits.h>
+#include <atomic>
 #include <madness/mra/adquad.h>
 #include <madness/tensor/aligned.h>
 #include <madness/tensor/tensor_lapack.h>
@@ -149,6 +150,33 @@ namespace madness {
         // SeparatedConvolutionData keeps data for all terms and all dimensions and 1 displacement
         mutable SimpleCache< SeparatedConvolutionData<Q,NDIM>, NDIM > data; ///< cache for all terms, dims and displacements
         mutable SimpleCache< SeparatedConvolutionData<Q,NDIM>, 2*NDIM > mod_data; ///< cache for all terms, dims and displacements
+        mutable SimpleCache< TensorTrain<double>, NDIM+1 > tt_data; ///< cache for the TT form of the operator, last index is log10(tol)
+
+    public:
+        /// operator norms of all displacements of one level, in the order of get_disp()
+
+        /// the displacements are sorted by distance, so a shell of displacements
+        /// with the same distance is a contiguous range
+        struct NormTable {
+            std::vector<double> norm;               ///< norm of each displacement
+            std::vector<std::size_t> shell_begin;   ///< first displacement of each shell, plus the end
+            std::vector<double> shell_max;          ///< largest norm within each shell
+            std::vector<double> tail_max;           ///< largest norm in this and all farther shells
+        };
+
+    private:
+        mutable SimpleCache< NormTable, 1 > norm_tables; ///< cache for the norm tables, key is the level
+
+        /// statistics of the displacement screening in apply
+        struct ScreeningStatistics {
+            std::atomic<std::size_t> nchecked{0};   ///< displacements whose norm was checked
+            std::atomic<std::size_t> nskipped{0};   ///< displacements skipped by the shell bounds
+            std::atomic<std::size_t> napplied{0};   ///< displacements that were applied
+            ScreeningStatistics() = default;
+            ScreeningStatistics(const ScreeningStatistics& other)
+                : nchecked(other.nchecked.load()), nskipped(other.nskipped.load()), napplied(other.napplied.load()) {}
+        };
+        mutable ScreeningStatistics screening_stats;
 
     public:
 
@@ -1042,6 +1070,74 @@ namespace madness {
         	}
         }
 
+        /// count the displacements checked, skipped by the shell bounds, and applied in apply
+        void add_screening_statistics(const std::size_t nchecked, const std::size_t nskipped,
+                const std::size_t napplied) const {
+            screening_stats.nchecked+=nchecked;
+            screening_stats.nskipped+=nskipped;
+            screening_stats.napplied+=napplied;
+        }
+
+        /// print the screening statistics summed over all processes (collective)
+        void print_screening_statistics() const {
+            double stats[3]={double(screening_stats.nchecked),double(screening_stats.nskipped),
+                    double(screening_stats.napplied)};
+            this->get_world().gop.sum(stats,3);
+            if (this->get_world().rank()==0) {
+                const double total=std::max(1.0,stats[0]+stats[1]);
+                print("displacements checked, skipped, applied",stats[0],stats[1],stats[2],
+                        " applied fraction",stats[2]/total);
+            }
+        }
+
+        void reset_screening_statistics() const {
+            screening_stats.nchecked=0;
+            screening_stats.nskipped=0;
+            screening_stats.napplied=0;
+        }
+
+        /// return the table of operator norms for all displacements of level n
+
+        /// only for the NS form, where the norm depends on the displacement only
+        const NormTable& get_norm_table(Level n) const {
+            MADNESS_ASSERT(not modified());
+            const NormTable* p = norm_tables.getptr(n,0);
+            if (p) return *p;
+
+            // same norm as in getop_ns(), but without constructing the operator data
+            const std::vector< Key<NDIM> >& disp = get_disp(n);
+            NormTable table;
+            table.norm.resize(disp.size());
+            uint64_t distsq=std::numeric_limits<uint64_t>::max();
+            for (std::size_t i=0; i<disp.size(); ++i) {
+                double norm=0.0;
+                for (int mu=0; mu<rank; ++mu) {
+                    const ConvolutionData1D<Q>* ops1d[NDIM];
+                    for (std::size_t d=0; d<NDIM; ++d) {
+                        ops1d[d] = ops[mu].getop(d)->nonstandard(n, disp[i].translation()[d]);
+                    }
+                    const double munorm = munorm2_ns(n, ops1d)*std::abs(ops[mu].getfac());
+                    norm += munorm*munorm;
+                }
+                table.norm[i] = sqrt(norm);
+
+                if (disp[i].distsq()!=distsq) {
+                    distsq=disp[i].distsq();
+                    table.shell_begin.push_back(i);
+                    table.shell_max.push_back(0.0);
+                }
+                table.shell_max.back() = std::max(table.shell_max.back(), table.norm[i]);
+            }
+            table.shell_begin.push_back(disp.size());
+            table.tail_max = table.shell_max;
+            for (long s=long(table.tail_max.size())-2; s>=0; --s) {
+                table.tail_max[s] = std::max(table.tail_max[s], table.tail_max[s+1]);
+            }
+
+            norm_tables.set(n,0,table);
+            return *norm_tables.getptr(n,0);
+        }
+
         const BoundaryConditions<NDIM>& get_bc() const {return bc;}
 
         const std::vector< Key<NDIM> >& get_disp(Level n) const {
@@ -1407,6 +1503,79 @@ namespace madness {
             return result;
         }
 
+#if HAVE_GENTENSOR
+        /// apply this operator on coefficients in tensor train form
+
+        /// source coefficients, operator and result are kept in TT form throughout;
+        /// the operator's TT representation is applied and the result is rounded
+        /// on the fly, so there are no full-rank intermediates.
+        /// @param[in]	coeff	source coeffs in TT form
+        /// @param[in]	tol		thresh/#neigh/cnorm
+        /// @param[in]	tol2	thresh/#neigh
+        template <typename T>
+        GenTensor<TENSOR_RESULT_TYPE(T,Q)> apply_tt(const Key<NDIM>& source,
+                                                const Key<NDIM>& shift,
+                                                const GenTensor<T>& coeff,
+                                                double tol, double tol2) const {
+            PROFILE_MEMBER_FUNC(SeparatedConvolution);
+            typedef TENSOR_RESULT_TYPE(T,Q) resultT;
+
+            if constexpr (std::is_same<T,double>::value and std::is_same<Q,double>::value) {
+                MADNESS_ASSERT(coeff.ndim()==NDIM);
+                MADNESS_ASSERT(coeff.is_tensortrain());
+                MADNESS_CHECK(not modified());
+
+                if (coeff.rank()==0) return GenTensor<resultT>(v2k,TT_TENSORTRAIN);
+
+                const GenTensor<T>* input = &coeff;
+                GenTensor<T> dummy;
+                if (coeff.dim(0) == k) {
+                    // leaf nodes with only scaling coefficients, see apply2
+                    dummy = GenTensor<T>(v2k,TT_TENSORTRAIN);
+                    dummy(s0) += coeff;
+                    input = &dummy;
+                } else {
+                    MADNESS_ASSERT(coeff.dim(0)==2*k);
+                }
+
+                const double eps=tol2*GenTensor<T>::fac_reduce();
+                double cpu0=cpu_time();
+                const TensorTrain<double>& op=get_tt_representation(source,shift,tol);
+                TensorTrain<resultT> result=madness::apply(op,input->get_tensortrain(),eps);
+                result.truncate(eps);
+                double cpu1=cpu_time();
+                timer_low_transf.accumulate(cpu1-cpu0);
+
+                GenTensor<resultT> final(result);
+                timer_stats_accumulate.accumulate(final.rank());
+                return final;
+            } else {
+                MADNESS_EXCEPTION("apply_tt is implemented for real operators and coefficients only",1);
+            }
+            return GenTensor<resultT>();
+        }
+#endif
+
+        /// return the TT representation of the operator including the R and T terms
+
+        /// the representations are cached per level and displacement; the truncation
+        /// tolerance is rounded down to a power of 10, which is kept in the last index
+        /// of the cache key.
+        /// @param[in]  tol     truncation threshold for the operator
+        const TensorTrain<double>& get_tt_representation(const Key<NDIM>& source,
+                const Key<NDIM>& shift, const double tol) const {
+            const Translation itol=std::max(-16l,long(std::floor(std::log10(std::max(tol,1.e-16)))));
+            Vector<Translation,NDIM+1> l;
+            for (std::size_t i=0; i<NDIM; ++i) l[i]=shift.translation()[i];
+            l[NDIM]=itol;
+            const Key<NDIM+1> key(source.level(),l);
+
+            const TensorTrain<double>* p=tt_data.getptr(key);
+            if (p) return *p;
+            tt_data.set(key,make_tt_representation(source,shift,std::pow(10.0,double(itol)),true,true));
+            return *tt_data.getptr(key);
+        }
+
         /// estimate the ratio of cost of full rank versus low rank
 
         /// @param[in]  source  source key
@@ -1424,6 +1593,7 @@ namespace madness {
 
             if (coeff.is_full_tensor()) return 0.5;
             if (2*NDIM==coeff.ndim()) return 1.5;
+            if (coeff.is_tensortrain() and (not modified())) return 1.5;
             MADNESS_ASSERT(NDIM==coeff.ndim());
             MADNESS_ASSERT(coeff.is_svd_tensor());
 
@@ -529,6 +529,57 @@ int test_convolution(World& world, const long& k, const double thresh) {
 }
 
 
+/// test the tensor train apply of the 6D operator against the full-rank apply on single boxes
+int test_tt_apply(World& world, const long& k, const double thresh) {
+    int nerror=0;
+#if HAVE_GENTENSOR
+    print("entering tt_apply");
+    real_convolution_6d green6 = BSHOperator<6>(world, 1.0, 1.e-4, 1.e-5);
+
+    // low-rank source coefficients: a sum of products of random vectors
+    Tensor<double> full(std::vector<long>(6,2*k));
+    for (int r=0; r<3; ++r) {
+        Tensor<double> term(2*k);
+        term.fillrandom();
+        for (int d=1; d<6; ++d) {
+            Tensor<double> v(2*k);
+            v.fillrandom();
+            term=outer(term,v);
+        }
+        full+=term;
+    }
+    const GenTensor<double> coeff(full,TensorArgs(1.e-8,TT_TENSORTRAIN));
+
+    // leaf nodes have only scaling coefficients
+    const std::vector<Slice> s0(6,Slice(0,k-1));
+    const Tensor<double> full_leaf=copy(full(s0));
+    const GenTensor<double> coeff_leaf(full_leaf,TensorArgs(1.e-8,TT_TENSORTRAIN));
+
+    const Key<6> source(2,Vector<Translation,6>(1));
+    const double tol=thresh*0.01;
+    for (Translation dx=0; dx<3; ++dx) {
+        Vector<Translation,6> l(0);
+        l[0]=dx;
+        const Key<6> shift(2,l);
+
+        const double cnorm=full.normf();
+        const Tensor<double> ref=green6.apply(source,shift,full,tol/cnorm);
+        const GenTensor<double> result=green6.apply_tt(source,shift,coeff,tol/cnorm,tol);
+        const double error=(ref-result.full_tensor_copy()).normf();
+        nerror+=check_small(error,10.0*tol,"tt apply, shift "+std::to_string(dx)+", rank "+std::to_string(result.rank()));
+
+        const double cnorm_leaf=full_leaf.normf();
+        const Tensor<double> ref_leaf=green6.apply(source,shift,full_leaf,tol/cnorm_leaf);
+        const GenTensor<double> result_leaf=green6.apply_tt(source,shift,coeff_leaf,tol/cnorm_leaf,tol);
+        const double error_leaf=(ref_leaf-result_leaf.full_tensor_copy()).normf();
+        nerror+=check_small(error_leaf,10.0*tol,"tt apply on leaf coefficients, shift "+std::to_string(dx));
+    }
+    print("all done\n");
+#endif
+    return nerror;
+}
+
+
 int test_replicate(World& world, const long& k, const double thresh) {
     real_function_3d phi=real_factory_3d(world).f(gauss_3d);
     auto map=phi.get_pmap();
@@ -707,6 +758,7 @@ int main(int argc, char**argv) {
     test(world,k,thresh);
     error+=test_hartree_product(world,k,thresh);
     error+=test_convolution(world,k,thresh);
+    error+=test_tt_apply(world,k,thresh);
     error+=test_multiply(world,k,thresh);
     error+=test_add(world,k,thresh);
     error+=test_exchange(world,k,thresh);
@@ -103,7 +103,7 @@ void simple_example(World &universe) {
 }
 
 /// test the cloud with message larger than chunk size set in cloud.replicate()
-int chunk_example(World &universe) {
+int chunk_example(World &universe, const bool use_shared_memory) {
     int test_size = 100;
     std::vector<int> testvec;
     for (int i=0; i<test_size; i++) {
@@ -111,8 +111,9 @@ int chunk_example(World &universe) {
     }
 
     {
-        test_output bla("testing replication");
+        test_output bla("testing replication, shared memory: "+std::to_string(use_shared_memory));
         Cloud cloud(universe);
+        cloud.set_use_shared_memory(use_shared_memory);
         auto recordlist = cloud.store(universe, testvec);
         cloud.replicate(50);
 
@@ -131,9 +132,10 @@ int main(int argc, char **argv) {
     madness::World &universe = madness::initialize(argc, argv);
     startup(universe, argc, argv);
 
-    chunk_example(universe);
-    simple_example(universe);
     int success = 0;
+    success+=chunk_example(universe,false);
+    success+=chunk_example(universe,true);
+    simple_example(universe);
     {
         Cloud cloud(universe);
 //        cloud.set_debug(true);
@@ -125,6 +125,50 @@ int test_partitioner(World& world) {
     return 0;
 }
 
+int test_cost_model(World& world) {
+
+    using partitionT  = MacroTaskPartitioner::partitionT;
+
+    vector_real_function_1d vf= zero_functions<double,1>(world,40);
+    auto tuple2=std::make_tuple(vf,3.0);
+
+    MacroTaskCostModel costs;
+    MacroTaskPartitioner mtp;
+    mtp.set_nsubworld(2).set_tasktype("test_cost_model").set_use_cost_model(false);
+    partitionT partition = mtp.partition_tasks(tuple2);
+
+    // no measurements: priorities are left unchanged
+    partitionT partition1=partition;
+    mtp.apply_cost_model(partition1,costs);
+    auto it=partition.begin();
+    for (auto p : partition1) MADNESS_CHECK(p.second==(it++)->second);
+
+    // measure the last batch only: it is expensive, all other batches are extrapolated
+    std::stringstream ss;
+    ss << partition.back().first;
+    costs.record("test_cost_model",ss.str(),100.0,0.1,partition.back().first.size_of_input());
+    MADNESS_CHECK(costs.has_cost("test_cost_model"));
+    MADNESS_CHECK(not costs.has_cost("unknown_task"));
+    MADNESS_CHECK(costs.get_cost("test_cost_model",ss.str()).ncalls==1);
+
+    mtp.apply_cost_model(partition1,costs);
+    print("\npartitioning with measured cost");
+    for (auto p : partition1) print(p);
+    MADNESS_CHECK(partition1.back().second==100.0);
+    double per_element=100.0/partition.back().first.size_of_input();
+    for (auto p : partition1) {
+        MADNESS_CHECK(std::abs(p.second - per_element*p.first.size_of_input())<1.e-10);
+    }
+
+    // moving average over repeated measurements
+    costs.record("test_cost_model",ss.str(),50.0,0.1,partition.back().first.size_of_input());
+    MADNESS_CHECK(costs.get_cost("test_cost_model",ss.str()).time==75.0);
+    costs.clear();
+    MADNESS_CHECK(costs.size()==0);
+
+    return 0;
+}
+
 int main(int argc, char **argv) {
 
     madness::World &universe = madness::initialize(argc, argv);
@@ -134,6 +178,7 @@ int main(int argc, char **argv) {
     success+=test_batch_1D(universe);
     success+=test_batch(universe);
     success+=test_partitioner(universe);
+    success+=test_cost_model(universe);
 //    success+=test_partitioner(universe);
 //    success+=test_partitioner(universe);
 
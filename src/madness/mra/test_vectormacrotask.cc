@@ -182,6 +182,7 @@ int test_deferred(World& universe, const std::vector<real_function_3d>& v3,
     taskq->run_all();
     taskq->cloud.print_timings(universe);
     taskq->cloud.clear_timings();
+    MADNESS_CHECK(taskq->get_subworld_utilization().size()==taskq->get_nsubworld());
     int success=check_vector(universe,ref,f2a,"test_deferred execution of task");
     return success;
 }
@@ -875,6 +875,7 @@ int test_coulomb(World& world) {
     START_TIMER;
     Function<double,3> r = apply_only(op,f) ;
     END_TIMER("apply");
+    op.print_screening_statistics();
 
 
     START_TIMER;
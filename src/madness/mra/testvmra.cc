@@ -301,6 +301,50 @@ void test_rot(World& world) {
 
 }
 
+template <typename T, int NDIM>
+void test_orthonormalize_cd(World& world) {
+    typedef std::shared_ptr< FunctionFunctorInterface<T,NDIM> > ffunctorT;
+
+    const double thresh=1.e-7;
+    Tensor<double> cell(NDIM,2);
+    for (std::size_t i=0; i<NDIM; ++i) {
+        cell(i,0) = -11.0-2*i;  // Deliberately asymmetric bounding box
+        cell(i,1) =  10.0+i;
+    }
+    FunctionDefaults<NDIM>::set_cell(cell);
+    FunctionDefaults<NDIM>::set_k(8);
+    FunctionDefaults<NDIM>::set_thresh(thresh);
+    FunctionDefaults<NDIM>::set_refine(true);
+    FunctionDefaults<NDIM>::set_initial_level(3);
+    FunctionDefaults<NDIM>::set_truncate_mode(1);
+
+    const int n=13;
+
+    if (world.rank() == 0)
+        print("testing distributed orthonormalize_cd<",archive::get_type_name<T>(),">");
+
+    std::vector< Function<T,NDIM> > v(n);
+    for (int i=0; i<n; ++i) {
+        ffunctorT f(RandomGaussian<T,NDIM>(FunctionDefaults<NDIM>::get_cell(),0.5));
+        v[i] = FunctionFactory<T,NDIM>(world).functor(f);
+    }
+
+    START_TIMER;
+    std::vector< Function<T,NDIM> > ref=orthonormalize_cd(v);
+    END_TIMER("replicated cd");
+
+    START_TIMER;
+    std::vector< Function<T,NDIM> > result=orthonormalize_cd_distributed(v);
+    END_TIMER("distributed cd");
+
+    Tensor<T> ovlp=matrix_inner(world,result,result);
+    for (int i=0; i<n; ++i) ovlp(i,i)-=T(1.0);
+    double err_ovlp=ovlp.normf();
+    double err_ref=norm2(world,sub(world,ref,result));
+    if (world.rank() == 0) print("error in the overlap, difference to replicated",err_ovlp,err_ref,"\n");
+    MADNESS_CHECK(err_ovlp<1.e-6 && err_ref<1.e-5);
+}
+
 template<typename T, int NDIM>
 void test_matrix_mul_sparse(World &world) {
     typedef std::shared_ptr<FunctionFunctorInterface<T, NDIM> > ffunctorT;
@@ -431,6 +475,8 @@ int main(int argc, char**argv) {
         test_matrix_mul_sparse<double,2>(world);
         test_matrix_mul_sparse<double,3>(world);
 
+        test_orthonormalize_cd<double,1>(world);
+
         if (!smalltest) test_multi_to_multi_op<3>(world);
 #if !HAVE_GENTENSOR
         test_inner<double,std::complex<double>,1,false>(world);
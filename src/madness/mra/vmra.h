@@ -271,7 +271,8 @@ namespace madness {
 
     /// change tree state of the functions
 
-    /// will respect fence
+    /// will respect fence; the state changes of all functions are started
+    /// without intermediate fences, so a single fence completes all of them
     /// @return v   for chaining
     template <typename T, std::size_t NDIM>
     const std::vector<Function<T,NDIM>>& change_tree_state(const std::vector<Function<T,NDIM>>& v,
@@ -289,7 +290,7 @@ namespace madness {
         World& world=dummy.world();
 
 //        if (not fence) world.gop.set_forbid_fence(true);    // make sure fence is respected
-        for (unsigned int i=0; i<v.size(); ++i) v[i].change_tree_state(finalstate,fence);
+        for (unsigned int i=0; i<v.size(); ++i) v[i].change_tree_state(finalstate,false);
 //        if (not fence) world.gop.set_forbid_fence(false);
         if (fence) world.gop.fence();
 
@@ -551,6 +552,122 @@ namespace madness {
     	return orthonormalize_cd(v,ovlp);
     }
 
+    /// Cholesky factorization of a column distributed matrix (collective call)
+
+    /// As for the replicated \c cholesky() the upper triangle of \c A
+    /// will hold the result and the lower triangle will be zeroed such
+    /// that input = inner(transpose(output),output).
+    ///
+    /// The factorization proceeds tile by tile: the owner of tile \c k
+    /// factorizes its diagonal block and forms its rows of the factor,
+    /// which are then broadcast for the update of the remaining tiles.
+    /// No process holds more than its own tile plus one row panel.
+    /// @param[in,out] A The real symmetric positive-definite \c (n,n) matrix
+    template <typename T>
+    void cholesky(DistributedMatrix<T>& A) {
+        MADNESS_CHECK(A.coldim()==A.rowdim() && A.is_column_distributed());
+
+        World& world = A.get_world();
+        const int64_t n = A.coldim();
+        Tensor<T>& t = A.data();
+        int64_t ilo, ihi;
+        A.local_colrange(ilo, ihi);
+
+        for (int64_t p=0; p<A.process_coldim(); ++p) {
+            int64_t klo, khi;
+            A.get_colrange(p, klo, khi);
+
+            Tensor<T> panel(khi-klo+1, n);
+            if (world.rank() == p) {
+                Tensor<T> Ukk = copy(t(_,Slice(klo,khi)));
+                cholesky(Ukk);
+                if (khi+1 < n) {
+                    Tensor<T> Ukkinv = inverse(Ukk);
+                    t(_,Slice(khi+1,n-1)) = inner(Ukkinv, t(_,Slice(khi+1,n-1)), 0, 0);
+                }
+                t(_,Slice(klo,khi)) = Ukk;
+                if (klo > 0) t(_,Slice(0,klo-1)) = T(0.0);
+                panel(___) = t(___);
+            }
+            world.gop.broadcast(panel.ptr(), panel.size(), p);
+
+            // update the tiles below with this row panel
+            if (ihi >= ilo && ilo > khi) {
+                Tensor<T> Uki = copy(panel(_,Slice(ilo,ihi)));
+                t -= inner(Uki, panel, 0, 0);
+            }
+        }
+    }
+
+    /// cholesky orthonormalization without pivoting with a distributed overlap matrix
+
+    /// The overlap matrix is factorized tile by tile, see cholesky(DistributedMatrix<T>&).
+    /// The coefficients X=U^{-1} are formed by backward substitution over the tiles,
+    /// and the transformation for each completed tile is started before the next
+    /// tile is computed.  No process holds the full overlap matrix.
+    /// @param[in] the vector to orthonormalize
+    /// @param[in] column distributed overlap matrix, destroyed on return!
+    template <typename T, std::size_t NDIM>
+    std::vector<Function<T,NDIM> > orthonormalize_cd(
+    		const std::vector<Function<T,NDIM> >& v,
+			DistributedMatrix<T>& ovlp) {
+
+    	if (v.empty()) return v;
+    	World& world=v.front().world();
+    	const int64_t n=v.size();
+    	MADNESS_CHECK(ovlp.coldim()==n);
+
+    	cholesky(ovlp);
+    	const Tensor<T>& U=ovlp.data();
+    	int64_t ilo, ihi;
+    	ovlp.local_colrange(ilo,ihi);
+
+    	// sum_{l>k} U_kl X_l for the local tile k
+    	Tensor<T> UX;
+    	if (ihi>=ilo) UX=Tensor<T>(ihi-ilo+1,n);
+
+    	std::vector<Function<T,NDIM> > result=zero_functions_compressed<T,NDIM>(world,n);
+    	compress(world,v);
+
+    	for (int64_t p=ovlp.process_coldim()-1; p>=0; --p) {
+    		int64_t klo, khi;
+    		ovlp.get_colrange(p,klo,khi);
+
+    		// X_k = U_kk^{-1} (1_k - sum_{l>k} U_kl X_l)
+    		Tensor<T> X(khi-klo+1,n);
+    		if (world.rank()==p) {
+    			UX.scale(-1.0);
+    			for (int64_t i=klo; i<=khi; ++i) UX(i-klo,i)+=T(1.0);
+    			X=inner(inverse(copy(U(_,Slice(klo,khi)))),UX);
+    		}
+    		world.gop.broadcast(X.ptr(),X.size(),p);
+
+    		// start the transformation for this tile, X is upper triangular
+    		for (int64_t i=klo; i<=khi; ++i) {
+    			for (int64_t j=i; j<n; ++j) {
+    				if (X(i-klo,j)!=T(0.0)) result[j].gaxpy(1.0,v[i],X(i-klo,j),false);
+    			}
+    		}
+
+    		if (ihi>=ilo && ihi<klo) UX+=inner(copy(U(_,Slice(klo,khi))),X);
+    	}
+    	world.gop.fence();
+    	return result;
+    }
+
+    /// convenience routine for cholesky orthonormalization with a distributed overlap matrix
+    /// @param[in] the vector to orthonormalize
+    template <typename T, std::size_t NDIM>
+    std::vector<Function<T,NDIM> > orthonormalize_cd_distributed(const std::vector<Function<T,NDIM> >& v){
+    	if(v.empty()) return v;
+
+    	World& world=v.front().world();
+    	const int64_t n=v.size();
+    	DistributedMatrix<T> ovlp = matrix_inner(column_distributed_matrix_distribution(world,n,n), v, v, true);
+
+    	return orthonormalize_cd(v,ovlp);
+    }
+
     /// @param[in] the vector to orthonormalize
     /// @param[in] overlap matrix, will be destroyed on return!
     /// @param[in] tolerance for numerical rank reduction
@@ -863,8 +980,9 @@ namespace madness {
                                                    bool sym=false)
     {
         world.gop.fence();
-        compress(world, f);
-        if ((void*)(&f) != (void*)(&g)) compress(world, g);
+        compress(world, f, false);
+        if ((void*)(&f) != (void*)(&g)) compress(world, g, false);
+        world.gop.fence();
 
         std::vector<const FunctionImpl<T,NDIM>*> left(f.size());
         std::vector<const FunctionImpl<R,NDIM>*> right(g.size());
@@ -895,8 +1013,9 @@ namespace madness {
         if (sym) MADNESS_ASSERT(n==m);
 
         world.gop.fence();
-        compress(world, f);
-        if ((void*)(&f) != (void*)(&g)) compress(world, g);
+        compress(world, f, false);
+        if ((void*)(&f) != (void*)(&g)) compress(world, g, false);
+        world.gop.fence();
 
         for (long i=0; i<n; ++i) {
             long jtop = m;
@@ -935,7 +1054,7 @@ namespace madness {
         MADNESS_CHECK(n==m);
         Tensor< TENSOR_RESULT_TYPE(T,R) > r(n);
 
-        compress(world, f);
+        compress(world, f, false);
         compress(world, g);
 
         for (long i=0; i<n; ++i) {
@@ -1226,7 +1345,7 @@ namespace madness {
         bool fence=true) {
         PROFILE_BLOCK(Vadd);
         MADNESS_ASSERT(a.size() == b.size());
-        compress(world, a);
+        compress(world, a, false);
         compress(world, b);
 
         std::vector< Function<TENSOR_RESULT_TYPE(T,R),NDIM> > r(a.size());
@@ -1273,7 +1392,7 @@ namespace madness {
         bool fence=true) {
         PROFILE_BLOCK(Vsub);
         MADNESS_ASSERT(a.size() == b.size());
-        compress(world, a);
+        compress(world, a, false);
         compress(world, b);
 
         std::vector< Function<TENSOR_RESULT_TYPE(T,R),NDIM> > r(a.size());
@@ -1324,7 +1443,7 @@ namespace madness {
         if (a.size()==0) return std::vector<Function<resultT,NDIM> >();
 
         World& world=a[0].world();
-        compress(world,a);
+        compress(world,a,false);
     	compress(world,b);
     	std::vector<Function<resultT,NDIM> > result(a.size());
         for (unsigned int i=0; i<a.size(); ++i) {
@@ -1368,7 +1487,7 @@ namespace madness {
                bool fence=true) {
         PROFILE_BLOCK(Vgaxpy);
         MADNESS_ASSERT(a.size() == b.size());
-        compress(world, a);
+        compress(world, a, false);
         compress(world, b);
 
         for (unsigned int i=0; i<a.size(); ++i) {
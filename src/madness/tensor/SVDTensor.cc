@@ -151,7 +151,7 @@ void SVDTensor<T>::recompute_from_range(const Tensor<T>& Q) {
 	// tensor = A = Q * Q(T) A = Q * Q(T) * left(T) * right
 	MADNESS_ASSERT(Q.dim(0)==this->flat_vector(0).dim(1));
 
-	const Tensor<T> U_ri=this->make_left_vector_with_weights();
+	const Tensor<T> U_ri=this->make_left_vector_with_weights().reshape(rank(),this->kVec(0));
 	const Tensor<T> V_rj=this->flat_vector(1);
 
 	Tensor<T> B=inner(inner(conj(Q),U_ri,0,1),V_rj,1,0);
@@ -226,7 +226,7 @@ void SVDTensor<T>::orthonormalize_random(const double& eps) {
 	long maxrank=std::min(this->kVec(0),this->kVec(1));
 
 	RandomizedMatrixDecomposition<T> rmd=RMDFactory().maxrank(maxrank);
-	Tensor<T> scr=this->make_left_vector_with_weights();
+	Tensor<T> scr=this->make_left_vector_with_weights().reshape(rank(),this->kVec(0));
 	Tensor<T> Q=rmd.compute_range(scr,this->flat_vector(1),eps*0.1);
 
 	recompute_from_range(Q);
@@ -235,6 +235,39 @@ void SVDTensor<T>::orthonormalize_random(const double& eps) {
 
 }
 
+/// reduce the rank of a sum of many terms
+
+/// The range finder grows its basis in blocks, so its cost scales with the
+/// rank of the result rather than the number of terms. Small inputs are
+/// orthonormalized directly; if the range turns out to be larger than half
+/// the input rank the sampling does not pay off and we fall back to the
+/// divide-and-conquer reduction.
+template<typename T>
+void SVDTensor<T>::randomized_reduce(const double& thresh) {
+
+	if (this->has_no_data() or rank()==0) return;
+	const long chunksize=8;
+	if (rank()<=chunksize) {
+		orthonormalize(thresh);
+		return;
+	}
+	this->normalize();
+
+	long maxrank=std::min(std::min(this->kVec(0),this->kVec(1)),rank()/2);
+	RandomizedMatrixDecomposition<T> rmd=RMDFactory().maxrank(maxrank);
+	Tensor<T> scr=this->make_left_vector_with_weights().reshape(rank(),this->kVec(0));
+	Tensor<T> Q=rmd.compute_range(scr,this->flat_vector(1),thresh*0.1);
+
+	if (rmd.exceeds_maxrank()) {
+		divide_and_conquer_reduce(thresh);
+	} else if (Q.size()==0) {
+		*this=SVDTensor<T>(this->ndim(),this->dims());
+	} else {
+		recompute_from_range(Q);
+		truncate_svd(thresh);
+	}
+}
+
 template<typename T>
 void SVDTensor<T>::truncate_svd(const double& thresh) {
 
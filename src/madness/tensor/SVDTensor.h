@@ -150,6 +150,9 @@ public:
 
 	void orthonormalize_random(const double& thresh);
 
+	// reduce the rank with a randomized range finder, exact for small ranks
+	void randomized_reduce(const double& thresh);
+
 	void truncate_svd(const double& thresh);
 
 	static std::string reduction_algorithm();
@@ -187,7 +190,7 @@ public:
     		return SVDTensor<T>(full,eps);
     	} else if (ref.reduction_algorithm()=="rmd") {
     		SVDTensor<T> result=SVDTensor<T>::concatenate(addends);
-    		result.orthonormalize_random(eps);
+    		result.randomized_reduce(eps);
     		return result;
     	} else {
     		MADNESS_EXCEPTION("unknown reduction algorithm in SVDTensor.h",1);
@@ -0,0 +1,350 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_TENSOR_FIXEDTENSOR_H__INCLUDED
+#define MADNESS_TENSOR_FIXEDTENSOR_H__INCLUDED
+
+/// \file fixedtensor.h
+/// \brief Coefficient blocks whose order \c K and dimension \c NDIM are known at compile time
+
+/// A \c FixedTensor<T,K,NDIM> holds the K^NDIM coefficients of one box inline
+/// (no heap allocation, no reference counting, 64-byte aligned) so that it can
+/// live on the stack of a task.  All loop bounds of its kernels are template
+/// parameters; the contraction over the first index in \c fast_transform is
+/// unrolled by a fold expression and the remaining loops have constant trip
+/// counts, which lets the compiler keep a row of the result in registers.
+///
+/// \c fixed_fast_transform() maps a runtime \c Tensor onto these kernels when
+/// its order is in \c FixedTensorOrders and its dimension is at most 3, and
+/// returns false otherwise so that the caller can fall back to the generic
+/// \c fast_transform().
+
+#include <madness/tensor/tensor.h>
+#include <cstddef>
+#include <utility>
+
+namespace madness {
+
+    /// The orders k for which fixed_fast_transform() has compiled kernels
+    typedef std::index_sequence<6,7,8,9,10> FixedTensorOrders;
+
+    /// The largest dimension for which fixed_fast_transform() has compiled kernels
+    static const std::size_t FIXED_TENSOR_MAXDIM = 3;
+
+    namespace detail {
+
+        template <std::size_t K, std::size_t NDIM>
+        struct fixed_size {
+            static constexpr std::size_t value = K*fixed_size<K,NDIM-1>::value;
+        };
+
+        template <std::size_t K>
+        struct fixed_size<K,0> {
+            static constexpr std::size_t value = 1;
+        };
+
+        /// ci[j] += a*b[j] for j in [0,N)
+        template <std::size_t N, typename R, typename T, typename Q>
+        inline void fixed_axpy(R* MADNESS_RESTRICT ci, const T a, const Q* MADNESS_RESTRICT b) {
+            for (std::size_t j=0; j<N; ++j) ci[j] += a*b[j];
+        }
+
+        /// c(i,j) = sum(k) a(k,i)*b(k,j) with the k loop unrolled
+        template <std::size_t DIMI, std::size_t DIMJ, typename R, typename T, typename Q, std::size_t... KK>
+        inline void fixed_mTxmq(R* MADNESS_RESTRICT c, const T* MADNESS_RESTRICT a,
+                                const Q* MADNESS_RESTRICT b, std::index_sequence<KK...>) {
+            for (std::size_t i=0; i<DIMI; ++i, ++a, c+=DIMJ) {
+                R ci[DIMJ] = {};
+                (fixed_axpy<DIMJ>(ci, a[KK*DIMI], b+KK*DIMJ), ...);
+                for (std::size_t j=0; j<DIMJ; ++j) c[j] = ci[j];
+            }
+        }
+
+        template <std::size_t NDIM, typename R, typename T, typename Q, std::size_t... KS>
+        bool fixed_dispatch(long k, const T* t, const Q* c, R* result, std::index_sequence<KS...>);
+
+    } // namespace detail
+
+    /// Matrix transpose times matrix with all dimensions fixed at compile time
+
+    /// \code
+    ///     c(i,j) = sum(k) a(k,i)*b(k,j)     i<DIMI, j<DIMJ, k<DIMK
+    /// \endcode
+    /// The result is overwritten (as in \c mTxmq).
+    template <std::size_t DIMI, std::size_t DIMJ, std::size_t DIMK, typename R, typename T, typename Q>
+    inline void fixed_mTxmq(R* MADNESS_RESTRICT c, const T* MADNESS_RESTRICT a, const Q* MADNESS_RESTRICT b) {
+        detail::fixed_mTxmq<DIMI,DIMJ>(c, a, b, std::make_index_sequence<DIMK>());
+    }
+
+    /// Transform all dimensions of a K^NDIM block by the K*K matrix c
+
+    /// Same operation as \c fast_transform() on raw contiguous storage.  The
+    /// input, result and workspace must be distinct and hold K^NDIM elements.
+    template <std::size_t K, std::size_t NDIM, typename R, typename T, typename Q>
+    inline R* fixed_fast_transform(const T* t, const Q* c, R* result, R* workspace) {
+        static_assert(NDIM>0, "fixed_fast_transform: NDIM must be positive");
+        constexpr std::size_t dimi = detail::fixed_size<K,NDIM-1>::value;
+        R *t0=workspace, *t1=result;
+        if (NDIM&1) std::swap(t0,t1);
+
+        fixed_mTxmq<dimi,K,K>(t0, t, c);
+        for (std::size_t n=1; n<NDIM; ++n) {
+            fixed_mTxmq<dimi,K,K>(t1, t0, c);
+            std::swap(t0,t1);
+        }
+        return result;
+    }
+
+    /// A block of K^NDIM coefficients held inline and aligned to a cache line
+
+    /// Default construction leaves the elements uninitialized, as does
+    /// \c Tensor(dims,false) .  Elements are in row-major (C) order, so that
+    /// \c ptr() can be used wherever contiguous \c Tensor storage is expected.
+    template <typename T, std::size_t K, std::size_t NDIM>
+    class FixedTensor {
+    public:
+        typedef T type;
+        typedef typename TensorTypeData<T>::scalar_type scalar_type;
+        typedef typename TensorTypeData<T>::float_scalar_type float_scalar_type;
+
+        static constexpr std::size_t k = K;
+        static constexpr std::size_t ndim = NDIM;
+        static constexpr std::size_t size = detail::fixed_size<K,NDIM>::value;
+
+        static_assert(NDIM>0 && NDIM<=TENSOR_MAXDIM, "FixedTensor: invalid number of dimensions");
+        static_assert(size*sizeof(T) <= 65536, "FixedTensor: too large to live on the stack, use Tensor");
+
+    private:
+        alignas(64) T v[size];
+
+    public:
+        FixedTensor() = default;
+
+        /// Copy from a contiguous tensor whose dimensions are all K
+        explicit FixedTensor(const Tensor<T>& t) {
+            MADNESS_ASSERT(t.ndim()==long(NDIM) && t.size()==long(size) && t.iscontiguous());
+            for (long d=0; d<t.ndim(); ++d) MADNESS_ASSERT(t.dim(d)==long(K));
+            const T* MADNESS_RESTRICT p = t.ptr();
+            for (std::size_t i=0; i<size; ++i) v[i] = p[i];
+        }
+
+        /// Set all elements to x
+        FixedTensor& operator=(T x) {
+            return fill(x);
+        }
+
+        /// Set all elements to x
+        FixedTensor& fill(T x) {
+            for (std::size_t i=0; i<size; ++i) v[i] = x;
+            return *this;
+        }
+
+        T* ptr() {return v;}
+
+        const T* ptr() const {return v;}
+
+        /// Element access by the flattened (row-major) index
+        T& operator[](std::size_t i) {return v[i];}
+
+        const T& operator[](std::size_t i) const {return v[i];}
+
+        /// Element access by NDIM indices
+        template <typename... I>
+        T& operator()(I... i) {
+            static_assert(sizeof...(I)==NDIM, "FixedTensor: wrong number of indices");
+            return v[index(i...)];
+        }
+
+        template <typename... I>
+        const T& operator()(I... i) const {
+            static_assert(sizeof...(I)==NDIM, "FixedTensor: wrong number of indices");
+            return v[index(i...)];
+        }
+
+        /// Returns a new (heap allocated) tensor with a copy of the data
+        Tensor<T> to_tensor() const {
+            std::vector<long> dims(NDIM,K);
+            Tensor<T> result(dims,false);
+            T* MADNESS_RESTRICT p = result.ptr();
+            for (std::size_t i=0; i<size; ++i) p[i] = v[i];
+            return result;
+        }
+
+        /// Inplace multiplication by a scalar
+        template <typename Q>
+        FixedTensor& scale(Q x) {
+            for (std::size_t i=0; i<size; ++i) v[i] *= x;
+            return *this;
+        }
+
+        /// Inplace element-wise multiplication
+        template <typename Q>
+        FixedTensor& emul(const FixedTensor<Q,K,NDIM>& b) {
+            const Q* MADNESS_RESTRICT p = b.ptr();
+            for (std::size_t i=0; i<size; ++i) v[i] *= p[i];
+            return *this;
+        }
+
+        /// Inplace generalized saxpy ... this = this*alpha + b*beta
+        template <typename Q>
+        FixedTensor& gaxpy(T alpha, const FixedTensor<Q,K,NDIM>& b, T beta) {
+            const Q* MADNESS_RESTRICT p = b.ptr();
+            for (std::size_t i=0; i<size; ++i) v[i] = v[i]*alpha + p[i]*beta;
+            return *this;
+        }
+
+        /// Frobenius norm
+        float_scalar_type normf() const {
+            float_scalar_type sum = 0;
+            for (std::size_t i=0; i<size; ++i) sum += std::norm(v[i]);
+            return float_scalar_type(std::sqrt(sum));
+        }
+
+        template <typename Archive>
+        void serialize(Archive& ar) {
+            ar & wrap(v,size);
+        }
+
+    private:
+        template <typename... I>
+        static std::size_t index(I... i) {
+            std::size_t result = 0;
+            ((result = result*K + std::size_t(i)), ...);
+            return result;
+        }
+    };
+
+    /// Full contraction of two blocks ... sum(i,j,...) a(i,j,...)*b(i,j,...)
+
+    /// Same as \c a.trace(b) for a \c Tensor (no complex conjugation).
+    template <typename T, typename Q, std::size_t K, std::size_t NDIM>
+    TENSOR_RESULT_TYPE(T,Q) inner(const FixedTensor<T,K,NDIM>& a, const FixedTensor<Q,K,NDIM>& b) {
+        TENSOR_RESULT_TYPE(T,Q) sum = 0;
+        const T* MADNESS_RESTRICT pa = a.ptr();
+        const Q* MADNESS_RESTRICT pb = b.ptr();
+        for (std::size_t i=0; i<FixedTensor<T,K,NDIM>::size; ++i) sum += pa[i]*pb[i];
+        return sum;
+    }
+
+    /// Returns a new block with the element-wise product of a and b
+    template <typename T, std::size_t K, std::size_t NDIM>
+    FixedTensor<T,K,NDIM> emul(const FixedTensor<T,K,NDIM>& a, const FixedTensor<T,K,NDIM>& b) {
+        FixedTensor<T,K,NDIM> result = a;
+        return result.emul(b);
+    }
+
+    /// Transform all dimensions of t by the K*K matrix c, the workspace is on the stack
+
+    /// \code
+    ///     result(i,j,k,...) <-- sum(i',j', k',...) t(i',j',k',...)  c(i',i) c(j',j) c(k',k) ...
+    /// \endcode
+    template <typename T, typename Q, std::size_t K, std::size_t NDIM>
+    FixedTensor<TENSOR_RESULT_TYPE(T,Q),K,NDIM>&
+    fast_transform(const FixedTensor<T,K,NDIM>& t, const FixedTensor<Q,K,2>& c,
+                   FixedTensor<TENSOR_RESULT_TYPE(T,Q),K,NDIM>& result) {
+        FixedTensor<TENSOR_RESULT_TYPE(T,Q),K,NDIM> workspace;
+        fixed_fast_transform<K,NDIM>(t.ptr(), c.ptr(), result.ptr(), workspace.ptr());
+        return result;
+    }
+
+    namespace detail {
+        template <std::size_t... KS>
+        constexpr bool is_fixed_order(long k, std::index_sequence<KS...>) {
+            return ((k==long(KS)) || ...);
+        }
+    }
+
+    /// Returns true if there is a compiled kernel for transforming t by c
+
+    /// Cheap enough to call before allocating the result, so that callers
+    /// that fall back to \c transform() do not allocate twice.
+    template <typename T, typename Q>
+    bool has_fixed_transform(const Tensor<T>& t, const Tensor<Q>& c) {
+        if (t.ndim()<1 || t.ndim()>3) return false;
+        if (c.ndim()!=2 || c.dim(0)!=c.dim(1) || !c.iscontiguous() || !t.iscontiguous()) return false;
+        const long k = c.dim(0);
+        if (!detail::is_fixed_order(k, FixedTensorOrders())) return false;
+        for (long d=0; d<t.ndim(); ++d) if (t.dim(d)!=k) return false;
+        return true;
+    }
+
+    /// Tries fast_transform() with the compiled kernels
+
+    /// The same restrictions as for \c fast_transform() apply, except that
+    /// no workspace is needed; the result must be preallocated with the
+    /// dimensions of \c t .
+    /// \return false (and result untouched) if the order or dimension of
+    /// \c t is not in the compiled set or \c t or \c c are not contiguous
+    template <typename T, typename Q>
+    bool fixed_fast_transform(const Tensor<T>& t, const Tensor<Q>& c, Tensor<TENSOR_RESULT_TYPE(T,Q)>& result) {
+        typedef TENSOR_RESULT_TYPE(T,Q) resultT;
+        if (!has_fixed_transform(t,c)) return false;
+        MADNESS_ASSERT(result.size()==t.size() && result.iscontiguous());
+
+        const long k = c.dim(0);
+        resultT* r = result.ptr();
+        switch (t.ndim()) {
+        case 1: return detail::fixed_dispatch<1>(k, t.ptr(), c.ptr(), r, FixedTensorOrders());
+        case 2: return detail::fixed_dispatch<2>(k, t.ptr(), c.ptr(), r, FixedTensorOrders());
+        case 3: return detail::fixed_dispatch<3>(k, t.ptr(), c.ptr(), r, FixedTensorOrders());
+        default: return false;
+        }
+    }
+
+    /// Same as \c transform() but uses the compiled kernels when possible
+
+    /// The result is allocated only once, by whichever path runs.
+    template <typename T, typename Q>
+    Tensor<TENSOR_RESULT_TYPE(T,Q)> fixed_transform(const Tensor<T>& t, const Tensor<Q>& c) {
+        if (!has_fixed_transform(t,c)) return transform(t,c);
+        Tensor<TENSOR_RESULT_TYPE(T,Q)> result(t.ndim(),t.dims(),false);
+        fixed_fast_transform(t,c,result);
+        return result;
+    }
+
+    namespace detail {
+
+        template <std::size_t K, std::size_t NDIM, typename R, typename T, typename Q>
+        void fixed_transform_stack(const T* t, const Q* c, R* result) {
+            FixedTensor<R,K,NDIM> workspace;
+            madness::fixed_fast_transform<K,NDIM>(t, c, result, workspace.ptr());
+        }
+
+        template <std::size_t NDIM, typename R, typename T, typename Q, std::size_t... KS>
+        bool fixed_dispatch(long k, const T* t, const Q* c, R* result, std::index_sequence<KS...>) {
+            return ((k==long(KS) ? (fixed_transform_stack<KS,NDIM>(t, c, result), true) : false) || ...);
+        }
+
+    } // namespace detail
+
+} // namespace madness
+
+#endif // MADNESS_TENSOR_FIXEDTENSOR_H__INCLUDED
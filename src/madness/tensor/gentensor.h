@@ -215,6 +215,7 @@ namespace madness {
 		size_t nCoeff() const {return this->size();}
 
         void reduce_rank(const double& eps) {return;};
+        void reduce_rank_randomized(const double& eps) {return;};
         void normalize() {return;}
 
         std::string what_am_i() const {return "GenTensor, aliased to Tensor";};
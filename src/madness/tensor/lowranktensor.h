@@ -621,7 +621,11 @@ public:
 	void add_SVD(const GenTensor& other, const double& thresh) {
 		if (is_full_tensor()) get_tensor()+=other.get_tensor();
 		else if (is_svd_tensor()) get_svdtensor().add_SVD(other.get_svdtensor(),thresh*facReduce());
-		else if (is_tensortrain()) get_tensortrain()+=(other.get_tensortrain());
+		else if (is_tensortrain()) {
+			// addition concatenates the cores, round the ranks back down
+			get_tensortrain()+=(other.get_tensortrain());
+			if constexpr (std::is_arithmetic<T>::value) get_tensortrain().truncate(thresh*facReduce());
+		}
         else {
 			MADNESS_EXCEPTION("unknown tensor type in LowRankTensor::add_SVD",1);
         }
@@ -650,6 +654,14 @@ public:
 		if (is_tensortrain()) get_tensortrain().truncate(thresh*facReduce());
     }
 
+    /// reduce the rank of a long sum of terms with a randomized range finder
+
+    /// used when accumulating many summands, see FunctionNode::accumulate
+    void reduce_rank_randomized(const double& thresh) {
+		if (is_svd_tensor()) get_svdtensor().randomized_reduce(thresh*facReduce());
+		if (is_tensortrain()) get_tensortrain().truncate(thresh*facReduce());
+    }
+
 
 public:
 
@@ -0,0 +1,348 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_TENSOR_SIMD_H__INCLUDED
+#define MADNESS_TENSOR_SIMD_H__INCLUDED
+
+/// \file simd.h
+/// \brief Vectorized kernels for contiguous tensor data
+
+/// These are the contiguous fast paths of the element-wise and reduction
+/// members of \c Tensor (\c sumsq, \c normf, \c trace, \c emul, \c gaxpy,
+/// \c scale, \c screen).  The generic templates are plain loops; the
+/// overloads for \c double and \c double_complex use AVX-512 or AVX2/FMA
+/// intrinsics when the compiler targets them (see madness_config.h) and
+/// otherwise a scalar loop with four independent accumulators so that the
+/// reductions are not serialized on the latency of a single add.
+///
+/// Complex data is processed as interleaved doubles where the operation acts
+/// the same on the real and imaginary parts (sums of squares, scaling by a real).
+///
+/// The reductions do not sum in the same order as the strided iterators,
+/// so results can differ from those in the last few bits.
+
+#include <madness/madness_config.h>
+#include <madness/tensor/basetensor.h>
+#include <cmath>
+#include <complex>
+
+#if defined(MADNESS_HAVE_AVX512) || (defined(MADNESS_HAVE_AVX2) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+namespace madness {
+    namespace simd {
+
+        // Generic versions ... any type, no explicit vectorization
+
+        /// Returns sum(i) a[i]*a[i]
+        template <typename T>
+        inline T sumsq(long n, const T* MADNESS_RESTRICT a) {
+            T sum = 0;
+            for (long i=0; i<n; ++i) sum += a[i]*a[i];
+            return sum;
+        }
+
+        /// Returns sum(i) |a[i]|^2
+        template <typename T>
+        inline typename TensorTypeData<T>::float_scalar_type normsq(long n, const T* MADNESS_RESTRICT a) {
+            typename TensorTypeData<T>::float_scalar_type sum = 0;
+            for (long i=0; i<n; ++i) sum += std::norm(a[i]);
+            return sum;
+        }
+
+        /// Returns sum(i) a[i]*b[i] (no complex conjugation)
+        template <typename T>
+        inline T dot(long n, const T* MADNESS_RESTRICT a, const T* MADNESS_RESTRICT b) {
+            T sum = 0;
+            for (long i=0; i<n; ++i) sum += a[i]*b[i];
+            return sum;
+        }
+
+        /// a[i] *= s
+        template <typename T, typename Q>
+        inline void scale(long n, T* MADNESS_RESTRICT a, Q s) {
+            for (long i=0; i<n; ++i) a[i] *= s;
+        }
+
+        /// a[i] *= b[i]
+        template <typename T>
+        inline void emul(long n, T* MADNESS_RESTRICT a, const T* MADNESS_RESTRICT b) {
+            for (long i=0; i<n; ++i) a[i] *= b[i];
+        }
+
+        /// a[i] = alpha*a[i] + beta*b[i]
+        template <typename T>
+        inline void gaxpy(long n, T* MADNESS_RESTRICT a, T alpha, const T* MADNESS_RESTRICT b, T beta) {
+            for (long i=0; i<n; ++i) a[i] = a[i]*alpha + b[i]*beta;
+        }
+
+        /// a[i] = alpha*a[i] + beta*b[i]*c[i]
+        template <typename T>
+        inline void gaxpy_emul(long n, T* MADNESS_RESTRICT a, T alpha,
+                               const T* MADNESS_RESTRICT b, const T* MADNESS_RESTRICT c, T beta) {
+            for (long i=0; i<n; ++i) a[i] = a[i]*alpha + b[i]*c[i]*beta;
+        }
+
+        /// a[i] = 0 where |a[i]| < thresh
+        template <typename T>
+        inline void screen(long n, T* MADNESS_RESTRICT a, double thresh) {
+            const T zero = 0;
+            for (long i=0; i<n; ++i) if (std::abs(a[i]) < thresh) a[i] = zero;
+        }
+
+        // double precision
+
+#if defined(MADNESS_HAVE_AVX512)
+
+        inline double sumsq(long n, const double* MADNESS_RESTRICT a) {
+            __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+            long i = 0;
+            for (; i+16<=n; i+=16) {
+                __m512d x0 = _mm512_loadu_pd(a+i), x1 = _mm512_loadu_pd(a+i+8);
+                s0 = _mm512_fmadd_pd(x0, x0, s0);
+                s1 = _mm512_fmadd_pd(x1, x1, s1);
+            }
+            double sum = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+            for (; i<n; ++i) sum += a[i]*a[i];
+            return sum;
+        }
+
+        inline double dot(long n, const double* MADNESS_RESTRICT a, const double* MADNESS_RESTRICT b) {
+            __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+            long i = 0;
+            for (; i+16<=n; i+=16) {
+                s0 = _mm512_fmadd_pd(_mm512_loadu_pd(a+i), _mm512_loadu_pd(b+i), s0);
+                s1 = _mm512_fmadd_pd(_mm512_loadu_pd(a+i+8), _mm512_loadu_pd(b+i+8), s1);
+            }
+            double sum = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+            for (; i<n; ++i) sum += a[i]*b[i];
+            return sum;
+        }
+
+        inline void scale(long n, double* MADNESS_RESTRICT a, double s) {
+            const __m512d vs = _mm512_set1_pd(s);
+            long i = 0;
+            for (; i+8<=n; i+=8) _mm512_storeu_pd(a+i, _mm512_mul_pd(_mm512_loadu_pd(a+i), vs));
+            for (; i<n; ++i) a[i] *= s;
+        }
+
+        inline void emul(long n, double* MADNESS_RESTRICT a, const double* MADNESS_RESTRICT b) {
+            long i = 0;
+            for (; i+8<=n; i+=8) _mm512_storeu_pd(a+i, _mm512_mul_pd(_mm512_loadu_pd(a+i), _mm512_loadu_pd(b+i)));
+            for (; i<n; ++i) a[i] *= b[i];
+        }
+
+        inline void gaxpy(long n, double* MADNESS_RESTRICT a, double alpha, const double* MADNESS_RESTRICT b, double beta) {
+            const __m512d va = _mm512_set1_pd(alpha), vb = _mm512_set1_pd(beta);
+            long i = 0;
+            for (; i+8<=n; i+=8) {
+                __m512d x = _mm512_mul_pd(_mm512_loadu_pd(a+i), va);
+                _mm512_storeu_pd(a+i, _mm512_fmadd_pd(_mm512_loadu_pd(b+i), vb, x));
+            }
+            for (; i<n; ++i) a[i] = a[i]*alpha + b[i]*beta;
+        }
+
+        inline void gaxpy_emul(long n, double* MADNESS_RESTRICT a, double alpha,
+                               const double* MADNESS_RESTRICT b, const double* MADNESS_RESTRICT c, double beta) {
+            const __m512d va = _mm512_set1_pd(alpha), vb = _mm512_set1_pd(beta);
+            long i = 0;
+            for (; i+8<=n; i+=8) {
+                __m512d bc = _mm512_mul_pd(_mm512_loadu_pd(b+i), _mm512_loadu_pd(c+i));
+                __m512d x = _mm512_mul_pd(_mm512_loadu_pd(a+i), va);
+                _mm512_storeu_pd(a+i, _mm512_fmadd_pd(bc, vb, x));
+            }
+            for (; i<n; ++i) a[i] = a[i]*alpha + b[i]*c[i]*beta;
+        }
+
+        inline void screen(long n, double* MADNESS_RESTRICT a, double thresh) {
+            const __m512d vt = _mm512_set1_pd(thresh);
+            long i = 0;
+            for (; i+8<=n; i+=8) {
+                __m512d x = _mm512_loadu_pd(a+i);
+                __mmask8 small = _mm512_cmp_pd_mask(_mm512_abs_pd(x), vt, _CMP_LT_OQ);
+                _mm512_storeu_pd(a+i, _mm512_mask_blend_pd(small, x, _mm512_setzero_pd()));
+            }
+            for (; i<n; ++i) if (std::abs(a[i]) < thresh) a[i] = 0.0;
+        }
+
+#elif defined(MADNESS_HAVE_AVX2) && defined(__FMA__)
+
+        namespace detail {
+            inline double hsum(__m256d x) {
+                __m128d lo = _mm256_castpd256_pd128(x), hi = _mm256_extractf128_pd(x, 1);
+                lo = _mm_add_pd(lo, hi);
+                return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+            }
+        }
+
+        inline double sumsq(long n, const double* MADNESS_RESTRICT a) {
+            __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+            long i = 0;
+            for (; i+8<=n; i+=8) {
+                __m256d x0 = _mm256_loadu_pd(a+i), x1 = _mm256_loadu_pd(a+i+4);
+                s0 = _mm256_fmadd_pd(x0, x0, s0);
+                s1 = _mm256_fmadd_pd(x1, x1, s1);
+            }
+            double sum = detail::hsum(_mm256_add_pd(s0, s1));
+            for (; i<n; ++i) sum += a[i]*a[i];
+            return sum;
+        }
+
+        inline double dot(long n, const double* MADNESS_RESTRICT a, const double* MADNESS_RESTRICT b) {
+            __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+            long i = 0;
+            for (; i+8<=n; i+=8) {
+                s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i), _mm256_loadu_pd(b+i), s0);
+                s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a+i+4), _mm256_loadu_pd(b+i+4), s1);
+            }
+            double sum = detail::hsum(_mm256_add_pd(s0, s1));
+            for (; i<n; ++i) sum += a[i]*b[i];
+            return sum;
+        }
+
+        inline void scale(long n, double* MADNESS_RESTRICT a, double s) {
+            const __m256d vs = _mm256_set1_pd(s);
+            long i = 0;
+            for (; i+4<=n; i+=4) _mm256_storeu_pd(a+i, _mm256_mul_pd(_mm256_loadu_pd(a+i), vs));
+            for (; i<n; ++i) a[i] *= s;
+        }
+
+        inline void emul(long n, double* MADNESS_RESTRICT a, const double* MADNESS_RESTRICT b) {
+            long i = 0;
+            for (; i+4<=n; i+=4) _mm256_storeu_pd(a+i, _mm256_mul_pd(_mm256_loadu_pd(a+i), _mm256_loadu_pd(b+i)));
+            for (; i<n; ++i) a[i] *= b[i];
+        }
+
+        inline void gaxpy(long n, double* MADNESS_RESTRICT a, double alpha, const double* MADNESS_RESTRICT b, double beta) {
+            const __m256d va = _mm256_set1_pd(alpha), vb = _mm256_set1_pd(beta);
+            long i = 0;
+            for (; i+4<=n; i+=4) {
+                __m256d x = _mm256_mul_pd(_mm256_loadu_pd(a+i), va);
+                _mm256_storeu_pd(a+i, _mm256_fmadd_pd(_mm256_loadu_pd(b+i), vb, x));
+            }
+            for (; i<n; ++i) a[i] = a[i]*alpha + b[i]*beta;
+        }
+
+        inline void gaxpy_emul(long n, double* MADNESS_RESTRICT a, double alpha,
+                               const double* MADNESS_RESTRICT b, const double* MADNESS_RESTRICT c, double beta) {
+            const __m256d va = _mm256_set1_pd(alpha), vb = _mm256_set1_pd(beta);
+            long i = 0;
+            for (; i+4<=n; i+=4) {
+                __m256d bc = _mm256_mul_pd(_mm256_loadu_pd(b+i), _mm256_loadu_pd(c+i));
+                __m256d x = _mm256_mul_pd(_mm256_loadu_pd(a+i), va);
+                _mm256_storeu_pd(a+i, _mm256_fmadd_pd(bc, vb, x));
+            }
+            for (; i<n; ++i) a[i] = a[i]*alpha + b[i]*c[i]*beta;
+        }
+
+        inline void screen(long n, double* MADNESS_RESTRICT a, double thresh) {
+            const __m256d vt = _mm256_set1_pd(thresh);
+            const __m256d mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+            long i = 0;
+            for (; i+4<=n; i+=4) {
+                __m256d x = _mm256_loadu_pd(a+i);
+                __m256d big = _mm256_cmp_pd(_mm256_and_pd(x, mask), vt, _CMP_NLT_UQ);
+                _mm256_storeu_pd(a+i, _mm256_and_pd(x, big));
+            }
+            for (; i<n; ++i) if (std::abs(a[i]) < thresh) a[i] = 0.0;
+        }
+
+#else
+
+        inline double sumsq(long n, const double* MADNESS_RESTRICT a) {
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            long i = 0;
+            for (; i+4<=n; i+=4) {
+                s0 += a[i  ]*a[i  ];
+                s1 += a[i+1]*a[i+1];
+                s2 += a[i+2]*a[i+2];
+                s3 += a[i+3]*a[i+3];
+            }
+            for (; i<n; ++i) s0 += a[i]*a[i];
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        inline double dot(long n, const double* MADNESS_RESTRICT a, const double* MADNESS_RESTRICT b) {
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            long i = 0;
+            for (; i+4<=n; i+=4) {
+                s0 += a[i  ]*b[i  ];
+                s1 += a[i+1]*b[i+1];
+                s2 += a[i+2]*b[i+2];
+                s3 += a[i+3]*b[i+3];
+            }
+            for (; i<n; ++i) s0 += a[i]*b[i];
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        inline void scale(long n, double* MADNESS_RESTRICT a, double s) {
+            for (long i=0; i<n; ++i) a[i] *= s;
+        }
+
+        inline void emul(long n, double* MADNESS_RESTRICT a, const double* MADNESS_RESTRICT b) {
+            for (long i=0; i<n; ++i) a[i] *= b[i];
+        }
+
+        inline void gaxpy(long n, double* MADNESS_RESTRICT a, double alpha, const double* MADNESS_RESTRICT b, double beta) {
+            for (long i=0; i<n; ++i) a[i] = a[i]*alpha + b[i]*beta;
+        }
+
+        inline void gaxpy_emul(long n, double* MADNESS_RESTRICT a, double alpha,
+                               const double* MADNESS_RESTRICT b, const double* MADNESS_RESTRICT c, double beta) {
+            for (long i=0; i<n; ++i) a[i] = a[i]*alpha + b[i]*c[i]*beta;
+        }
+
+        inline void screen(long n, double* MADNESS_RESTRICT a, double thresh) {
+            // branch free so that it vectorizes
+            for (long i=0; i<n; ++i) a[i] = (std::abs(a[i]) < thresh) ? 0.0 : a[i];
+        }
+
+#endif
+
+        inline double normsq(long n, const double* MADNESS_RESTRICT a) {
+            return sumsq(n, a);
+        }
+
+        // double complex ... as interleaved doubles where possible
+
+        inline double normsq(long n, const double_complex* MADNESS_RESTRICT a) {
+            return sumsq(2*n, reinterpret_cast<const double*>(a));
+        }
+
+        inline void scale(long n, double_complex* MADNESS_RESTRICT a, double s) {
+            scale(2*n, reinterpret_cast<double*>(a), s);
+        }
+
+    } // namespace simd
+} // namespace madness
+
+#endif // MADNESS_TENSOR_SIMD_H__INCLUDED
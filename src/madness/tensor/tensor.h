@@ -45,6 +45,7 @@
 #include <cstddef>
 
 #include <madness/world/archive.h>
+#include <madness/world/buffer_archive.h>
 // #include <madness/world/print.h>
 //
 // typedef std::complex<float> float_complex;
@@ -57,6 +58,7 @@
 // #include <madness/tensor/vector_factory.h>
 #include <madness/tensor/basetensor.h>
 #include <madness/tensor/aligned.h>
+#include <madness/tensor/simd.h>
 #include <madness/tensor/mxm.h>
 #include <madness/tensor/tensorexcept.h>
 #include <madness/tensor/tensoriter.h>
@@ -313,6 +315,10 @@ namespace madness {
     /// \ingroup tensor
     template <class T> class Tensor : public BaseTensor {
         template <class U> friend class SliceTensor;
+#ifndef TENSOR_USE_SHARED_ALIGNED_ARRAY
+        friend struct archive::ArchiveStoreImpl< archive::BufferOutputArchive, Tensor<T> >;
+        friend struct archive::ArchiveLoadImpl< archive::BufferInputArchive, Tensor<T> >;
+#endif
 
     protected:
         T* MADNESS_RESTRICT _p;
@@ -398,6 +404,16 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
             _ndim = -1;
         }
 
+#ifndef TENSOR_USE_SHARED_ALIGNED_ARRAY
+        // Use memory owned elsewhere (e.g., a message buffer) as contiguous data
+        void adopt(long nd, const long d[], std::shared_ptr<T> data) {
+            _id = TensorTypeData<T>::id;
+            set_dims_and_size(nd, d);
+            _p = data.get();
+            _shptr = std::move(data);
+        }
+#endif
+
     public:
         /// C++ typename of this tensor.
         typedef T type;
@@ -670,7 +686,12 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
         template <typename Q>
         typename IsSupported<TensorTypeData<Q>,Tensor<T>&>::type
         operator*=(const Q& x) {
-            UNARY_OPTIMIZED_ITERATOR(T, (*this), *_p0 *= x);
+            if (iscontiguous()) {
+                simd::scale(_size, _p, x);
+            }
+            else {
+                UNARY_OPTIMIZED_ITERATOR(T, (*this), *_p0 *= x);
+            }
             return *this;
         }
 
@@ -753,8 +774,13 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
         /// @param[in] x Scalar value
         /// @return %Reference to this tensor
         Tensor<T>& screen(double x) {
-            T zero = 0;
-            UNARY_OPTIMIZED_ITERATOR(T,(*this), if (std::abs(*_p0)<x) *_p0=zero);
+            if (iscontiguous()) {
+                simd::screen(_size, _p, x);
+            }
+            else {
+                T zero = 0;
+                UNARY_OPTIMIZED_ITERATOR(T,(*this), if (std::abs(*_p0)<x) *_p0=zero);
+            }
             return *this;
         }
 
@@ -1664,6 +1690,7 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
 
         /// Returns the sum of the squares of the elements
         T sumsq() const {
+            if (iscontiguous()) return simd::sumsq(_size, _p);
             T result = 0;
             UNARY_OPTIMIZED_ITERATOR(const T,(*this),result += (*_p0) * (*_p0));
             return result;
@@ -1721,6 +1748,9 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
 
         /// Returns the Frobenius norm of the tensor
         float_scalar_type normf() const {
+            if constexpr (std::is_floating_point<scalar_type>::value) {
+                if (iscontiguous()) return (float_scalar_type) std::sqrt(simd::normsq(_size, _p));
+            }
             float_scalar_type result = 0;
             UNARY_OPTIMIZED_ITERATOR(const T,(*this),result += ::madness::detail::mynorm(*_p0));
             return (float_scalar_type) std::sqrt(result);
@@ -1771,6 +1801,7 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
 
         /// Return the trace of two tensors (no complex conjugate invoked)
         T trace(const Tensor<T>& t) const {
+            if (iscontiguous() && t.iscontiguous() && conforms(t)) return simd::dot(_size, _p, t._p);
             T result = 0;
             BINARY_OPTIMIZED_ITERATOR(const T,(*this),const T,t,result += (*_p0)*(*_p1));
             return result;
@@ -1793,21 +1824,19 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
 
         /// Inplace multiply by corresponding elements of argument Tensor
         Tensor<T>& emul(const Tensor<T>& t) {
-            BINARY_OPTIMIZED_ITERATOR(T,(*this),const T,t,*_p0 *= *_p1);
+            if (iscontiguous() && t.iscontiguous() && conforms(t)) {
+                simd::emul(_size, _p, t._p);
+            }
+            else {
+                BINARY_OPTIMIZED_ITERATOR(T,(*this),const T,t,*_p0 *= *_p1);
+            }
             return *this;
         }
 
         /// Inplace generalized saxpy ... this = this*alpha + other*beta
         Tensor<T>& gaxpy(T alpha, const Tensor<T>& t, T beta) {
-            if (iscontiguous() && t.iscontiguous()) {
-                T* MADNESS_RESTRICT a = ptr();
-                const T* MADNESS_RESTRICT b = t.ptr();
-                if (alpha == T(1.0)) {
-                    for (long i=0; i<_size; ++i) a[i] += b[i]*beta;
-                }
-                else {
-                    for (long i=0; i<_size; ++i) a[i] = a[i]*alpha + b[i]*beta;
-                }
+            if (iscontiguous() && t.iscontiguous() && conforms(t)) {
+                simd::gaxpy(_size, _p, alpha, t._p, beta);
             }
             else {
                 //BINARYITERATOR(T,(*this),T,t, (*_p0) = alpha*(*_p0) + beta*(*_p1));
@@ -1817,6 +1846,17 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
             return *this;
         }
 
+        /// Inplace fused multiply-add ... this = this*alpha + b*c*beta (element-wise)
+        Tensor<T>& gaxpy_emul(T alpha, const Tensor<T>& b, const Tensor<T>& c, T beta) {
+            if (iscontiguous() && b.iscontiguous() && c.iscontiguous() && conforms(b) && conforms(c)) {
+                simd::gaxpy_emul(_size, _p, alpha, b._p, c._p, beta);
+            }
+            else {
+                TERNARY_OPTIMIZED_ITERATOR(T,(*this),const T,b,const T,c, (*_p0) = alpha*(*_p0) + beta*(*_p1)*(*_p2));
+            }
+            return *this;
+        }
+
         /// Returns a pointer to the internal data
         T* ptr() {
             return _p;
@@ -1924,6 +1964,55 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
             };
         };
 
+#ifndef TENSOR_USE_SHARED_ALIGNED_ARRAY
+        /// Serialize a tensor into a buffer ... large data may be sent without copying
+        template <typename T>
+        struct ArchiveStoreImpl< BufferOutputArchive, Tensor<T> > {
+            static void store(const BufferOutputArchive& s, const Tensor<T>& t) {
+                if (t.iscontiguous()) {
+                    s & t.size() & t.id();
+                    if (t.size()) {
+                        s & t.ndim() & wrap(t.dims(),TENSOR_MAXDIM);
+                        s.store_segment(t.ptr(), t.size(), std::shared_ptr<const void>(t._shptr));
+                    }
+                }
+                else {
+                    s & copy(t);
+                }
+            };
+        };
+
+
+        /// Deserialize a tensor from a buffer ... large data is adopted from the buffer if possible
+        template <typename T>
+        struct ArchiveLoadImpl< BufferInputArchive, Tensor<T> > {
+            static void load(const BufferInputArchive& s, Tensor<T>& t) {
+                long sz = 0l, id = 0l;
+                s & sz & id;
+                if (id != t.id()) throw "type mismatch deserializing a tensor";
+                if (sz) {
+                    long _ndim = 0l, _dim[TENSOR_MAXDIM];
+                    s & _ndim & wrap(_dim,TENSOR_MAXDIM);
+                    long n = 1;
+                    for (long i=0; i<_ndim; ++i) n *= _dim[i];
+                    if (sz != n) throw "size mismatch deserializing a tensor";
+                    std::shared_ptr<T> data = s.template borrow_segment<T>(sz);
+                    if (data) {
+                        t = Tensor<T>();
+                        t.adopt(_ndim, _dim, std::move(data));
+                    }
+                    else {
+                        t = Tensor<T>(_ndim, _dim, false);
+                        s.load_segment(t.ptr(), t.size());
+                    }
+                }
+                else {
+                    t = Tensor<T>();
+                }
+            };
+        };
+#endif
+
     }
 
     /// The class defines tensor op scalar ... here define scalar op tensor.
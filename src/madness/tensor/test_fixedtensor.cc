@@ -0,0 +1,149 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/// \file test_fixedtensor.cc
+/// \brief Checks the FixedTensor kernels against Tensor and times fast_transform
+
+#include <madness/world/safempi.h>
+#include <madness/tensor/fixedtensor.h>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace madness;
+
+bool smalltest = false;
+int nerror = 0;
+
+void check(const char* what, long k, long ndim, double err, double tol=1e-12) {
+    if (err > tol) {
+        printf("test_fixedtensor: %s k=%ld ndim=%ld error %.2e\n", what, k, ndim, err);
+        ++nerror;
+    }
+}
+
+/// Compares the kernels of FixedTensor<T,K,NDIM> with the Tensor operations
+template <typename T, std::size_t K, std::size_t NDIM>
+void test_kernels() {
+    std::vector<long> dims(NDIM,K);
+    Tensor<T> a(dims), b(dims);
+    Tensor<double> c(dims[0],dims[0]);
+    a.fillrandom(); b.fillrandom(); c.fillrandom();
+
+    FixedTensor<T,K,NDIM> fa(a), fb(b);
+    FixedTensor<double,K,2> fc(c);
+
+    FixedTensor<T,K,NDIM> fr;
+    fast_transform(fa, fc, fr);
+    check("fast_transform", K, NDIM, (fr.to_tensor() - transform(a,c)).normf());
+
+    // Dispatch from runtime tensors
+    Tensor<T> r(NDIM,a.dims(),false);
+    MADNESS_CHECK(fixed_fast_transform(a,c,r));
+    check("fixed_fast_transform", K, NDIM, (r - transform(a,c)).normf());
+
+    check("inner", K, NDIM, std::abs(inner(fa,fb) - a.trace(b)));
+    check("normf", K, NDIM, std::abs(fa.normf() - a.normf()));
+    check("emul", K, NDIM, (emul(fa,fb).to_tensor() - a.emul(b)).normf());
+
+    FixedTensor<T,K,NDIM> fg = FixedTensor<T,K,NDIM>(a);
+    fg.gaxpy(T(2.0), fb, T(-0.5));
+    check("gaxpy", K, NDIM, (fg.to_tensor() - copy(a).gaxpy(T(2.0),b,T(-0.5))).normf());
+}
+
+/// Time per call of the generic and of the compiled fast_transform
+template <std::size_t K, std::size_t NDIM>
+void time_transform() {
+    std::vector<long> dims(NDIM,K);
+    Tensor<double> t(dims), r(dims), w(dims);
+    Tensor<double> c(dims[0],dims[0]);
+    t.fillrandom(); c.fillrandom();
+    c.scale(1.0/K);
+
+    const long nloop = smalltest ? 200 : 20000;
+    double generic = 1e99, fixed = 1e99;
+    for (int rep=0; rep<5; ++rep) {
+        double start = SafeMPI::Wtime();
+        for (long i=0; i<nloop; ++i) fast_transform(t, c, r, w);
+        generic = std::min(generic, SafeMPI::Wtime() - start);
+
+        start = SafeMPI::Wtime();
+        for (long i=0; i<nloop; ++i) fixed_fast_transform(t, c, r);
+        fixed = std::min(fixed, SafeMPI::Wtime() - start);
+    }
+    printf("%4zu %4zu %12.3f %12.3f %8.2f\n", K, NDIM, 1e6*generic/nloop, 1e6*fixed/nloop, generic/fixed);
+}
+
+int main(int argc, char** argv) {
+    if (getenv("MAD_SMALL_TESTS")) smalltest=true;
+    for (int iarg=1; iarg<argc; iarg++) if (strcmp(argv[iarg],"--small")==0) smalltest=true;
+    SafeMPI::Init_thread(argc, argv, MPI_THREAD_SINGLE);
+
+    test_kernels<double,6,1>();
+    test_kernels<double,8,2>();
+    test_kernels<double,6,3>();
+    test_kernels<double,7,3>();
+    test_kernels<double,10,3>();
+    test_kernels<std::complex<double>,8,3>();
+
+    Tensor<double> a(6,6,6);
+    a.fillindex();
+    FixedTensor<double,6,3> fa(a);
+    if (fa(1,2,3) != a(1,2,3)) ++nerror;
+
+    // Not in the compiled set, the caller must fall back
+    Tensor<double> t(11,11,11), r(11,11,11), c(11,11);
+    MADNESS_CHECK(!fixed_fast_transform(t,c,r));
+    Tensor<double> t4(6,6,6,6), r4(6,6,6,6), c6(6,6);
+    MADNESS_CHECK(!fixed_fast_transform(t4,c6,r4));
+    MADNESS_CHECK(!has_fixed_transform(t,c) && !has_fixed_transform(t4,c6));
+    MADNESS_CHECK(has_fixed_transform(a,c6));
+    t4.fillrandom(); c6.fillrandom();
+    check("fixed_transform fallback", 6, 4, (fixed_transform(t4,c6) - transform(t4,c6)).normf());
+
+    if (nerror) {
+        printf("test_fixedtensor: %d errors\n", nerror);
+        SafeMPI::Finalize();
+        return 1;
+    }
+    printf("test_fixedtensor: kernels OK\n");
+
+    printf("\nfast_transform time per call (us)\n");
+    printf("%4s %4s %12s %12s %8s\n", "k", "ndim", "generic", "fixed", "speedup");
+    time_transform<6,3>();
+    time_transform<8,3>();
+    time_transform<10,3>();
+    time_transform<8,2>();
+
+    SafeMPI::Finalize();
+    return 0;
+}
@@ -650,6 +650,95 @@ namespace {
         }
     }
 
+
+    /// randomized orthonormalization of a 6D SVDTensor, whose vectors are
+    /// not matrices but (rank,k,k,k) tensors
+    TEST(LowRankAccumulationTest, OrthonormalizeRandom6D) {
+    	const long k=6, rank=20;
+    	const std::vector<long> dim(6,k);
+    	Tensor<double> U(rank,k*k*k), V(rank,k*k*k), w(rank);
+    	U.fillrandom();
+    	V.fillrandom();
+    	w=1.0;
+    	SVDTensor<double> svd(w,U,V,6,&dim.front());
+    	const Tensor<double> reference=svd.reconstruct();
+
+    	SVDTensor<double> random=copy(svd);
+    	random.orthonormalize_random(1.e-8);
+    	ASSERT_LT((random.reconstruct()-reference).normf(),1.e-6);
+
+    	SVDTensor<double> reduced=copy(svd);
+    	reduced.randomized_reduce(1.e-8);
+    	ASSERT_LT((reduced.reconstruct()-reference).normf(),1.e-6);
+    	ASSERT_LE(reduced.rank(),rank);
+    }
+
+    /// accumulate many low-rank summands of a 6D tensor, as in apply
+
+    /// compares add_SVD of each summand with concatenation and batched
+    /// (randomized) rank reduction, for accuracy and speed
+    TEST(LowRankAccumulationTest, BatchedReduction) {
+    	const long k=10, nsummand=256, nbasis=48, batch_rank=64;
+    	const std::vector<long> dim(6,k);
+
+    	// the summands share a basis with decaying weights, so the rank
+    	// of the sum depends on the threshold
+    	Tensor<double> U(nbasis,k*k*k), V(nbasis,k*k*k);
+    	U.fillrandom();
+    	V.fillrandom();
+    	for (long j=0; j<nbasis; ++j) {
+    		U(j,_)*=exp(-0.5*j)/U(j,_).normf();
+    		V(j,_)*=1.0/V(j,_).normf();
+    	}
+
+    	for (double thresh : {1.e-3, 1.e-5}) {
+    		Tensor<double> reference(dim);
+    		std::vector<GenTensor<double> > summands;
+    		for (long i=0; i<nsummand; ++i) {
+    			Tensor<double> X(2l,nbasis), Y(2l,nbasis), w(2l);
+    			X.fillrandom();
+    			Y.fillrandom();
+    			w=1.0/(i+1);
+    			SVDTensor<double> svd(w,inner(X,U),inner(Y,V),6,&dim.front());
+    			GenTensor<double> g(svd);
+    			g.reduce_rank(thresh*0.01);
+    			reference+=g.full_tensor_copy();
+    			summands.push_back(g);
+    		}
+
+    		// one SVD per summand
+    		double wall0=wall_time();
+    		GenTensor<double> svd_sum=copy(summands[0]);
+    		for (long i=1; i<nsummand; ++i) svd_sum.add_SVD(summands[i],thresh);
+    		double wall1=wall_time();
+
+    		// concatenate and compress in batches
+    		GenTensor<double> batch, buffer;
+    		for (long i=0; i<nsummand; ++i) {
+    			if (batch.has_data()) batch+=summands[i];
+    			else batch=copy(summands[i]);
+    			if (batch.rank()>std::max(batch_rank,buffer.rank())) {
+    				if (buffer.has_data()) buffer+=batch;
+    				else buffer=batch;
+    				buffer.reduce_rank_randomized(thresh);
+    				batch=GenTensor<double>();
+    			}
+    		}
+    		if (batch.has_data()) buffer+=batch;
+    		buffer.reduce_rank_randomized(thresh);
+    		double wall2=wall_time();
+
+    		const double svd_err=(svd_sum.full_tensor_copy()-reference).normf();
+    		const double batch_err=(buffer.full_tensor_copy()-reference).normf();
+    		print("accumulation thresh",thresh,"rank",svd_sum.rank(),buffer.rank(),
+    				"error",svd_err,batch_err,"time add_SVD",wall1-wall0,"batched",wall2-wall1);
+
+    		ASSERT_LT(batch_err,thresh);
+    		ASSERT_LT(batch_err,svd_err);
+    		ASSERT_LE(buffer.rank(),nbasis);
+    	}
+    }
+
 }
 
 int main(int argc, char** argv) {
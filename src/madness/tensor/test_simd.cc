@@ -0,0 +1,176 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/// \file test_simd.cc
+/// \brief Checks the contiguous tensor kernels against the iterator macros and times both
+
+#include <madness/world/safempi.h>
+#include <madness/tensor/tensor.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace madness;
+
+bool smalltest = false;
+int nerror = 0;
+
+void check(const char* what, long n, double err, double tol=1e-12) {
+    if (err > tol) {
+        printf("test_simd: %s n=%ld error %.2e\n", what, n, err);
+        ++nerror;
+    }
+}
+
+/// Compares the Tensor members (which take the contiguous kernels) with the macros
+template <typename T>
+void test_kernels(long n) {
+    Tensor<T> a(n), b(n), c(n);
+    a.fillrandom(); b.fillrandom(); c.fillrandom();
+    a -= T(0.5);
+    const double scl = std::max(1.0, double(n));
+    const double tol = 100*std::numeric_limits<typename TensorTypeData<T>::scalar_type>::epsilon();
+
+    T ref = 0;
+    UNARY_OPTIMIZED_ITERATOR(const T, a, ref += (*_p0) * (*_p0));
+    check("sumsq", n, std::abs(a.sumsq() - ref)/scl, tol);
+
+    double nref = 0;
+    UNARY_OPTIMIZED_ITERATOR(const T, a, nref += std::norm(*_p0));
+    check("normf", n, std::abs(a.normf() - std::sqrt(nref))/scl, tol);
+
+    ref = 0;
+    BINARY_OPTIMIZED_ITERATOR(const T, a, const T, b, ref += (*_p0) * (*_p1));
+    check("trace", n, std::abs(a.trace(b) - ref)/scl, tol);
+
+    Tensor<T> r = copy(a), x = copy(a);
+    BINARY_OPTIMIZED_ITERATOR(T, r, const T, b, *_p0 *= *_p1);
+    check("emul", n, (x.emul(b) - r).normf(), tol*scl);
+
+    r = copy(a); x = copy(a);
+    BINARY_OPTIMIZED_ITERATOR(T, r, const T, b, *_p0 = T(0.3)*(*_p0) + T(-1.7)*(*_p1));
+    check("gaxpy", n, (x.gaxpy(T(0.3), b, T(-1.7)) - r).normf(), tol*scl);
+
+    r = copy(a); x = copy(a);
+    TERNARY_OPTIMIZED_ITERATOR(T, r, const T, b, const T, c, *_p0 = T(0.3)*(*_p0) + T(-1.7)*(*_p1)*(*_p2));
+    check("gaxpy_emul", n, (x.gaxpy_emul(T(0.3), b, c, T(-1.7)) - r).normf(), tol*scl);
+
+    r = copy(a); x = copy(a);
+    UNARY_OPTIMIZED_ITERATOR(T, r, *_p0 *= 2.5);
+    check("scale", n, (x.scale(2.5) - r).normf(), tol*scl);
+
+    r = copy(a); x = copy(a);
+    UNARY_OPTIMIZED_ITERATOR(T, r, if (std::abs(*_p0)<0.25) *_p0=T(0));
+    check("screen", n, (x.screen(0.25) - r).normf(), 0.0);
+}
+
+/// The contiguous kernels must not accept operands of a different shape
+bool test_shapes() {
+    Tensor<double> a(2,3), b(3,4), c(2,3);
+    a.fillrandom(); b.fillrandom(); c.fillrandom();
+    Tensor<double> d = b(_,Slice(0,1));     // 3x2, not contiguous
+    int nthrow = 0;
+    try {a.trace(d);} catch (const TensorException&) {++nthrow;}
+    try {a.emul(d);} catch (const TensorException&) {++nthrow;}
+    try {a.gaxpy(1.0,d,1.0);} catch (const TensorException&) {++nthrow;}
+    try {a.gaxpy_emul(1.0,c,d,1.0);} catch (const TensorException&) {++nthrow;}
+    if (nthrow != 4) {
+        printf("test_simd: %d of 4 non-conforming operations did not throw\n", 4-nthrow);
+        ++nerror;
+        return false;
+    }
+    return true;
+}
+
+/// Returns the best time per call over several repetitions
+template <typename opT>
+double best_time(long nloop, opT op) {
+    double best = 1e99;
+    for (int rep=0; rep<5; ++rep) {
+        double start = SafeMPI::Wtime();
+        for (long i=0; i<nloop; ++i) op();
+        best = std::min(best, SafeMPI::Wtime() - start);
+    }
+    return best/nloop;
+}
+
+/// Times the kernels for a contiguous tensor of n doubles against the macros
+void time_kernels(long n) {
+    Tensor<double> a(n), b(n), c(n);
+    a.fillrandom(); b.fillrandom(); c.fillrandom();
+    const long nloop = std::max(10L, (smalltest ? 200000L : 20000000L)/n);
+    double sum = 0.0;
+
+    printf("%8ld %-12s %10.3f %10.3f\n", n, "sumsq",
+           1e6*best_time(nloop, [&]{double s=0; UNARY_OPTIMIZED_ITERATOR(const double, a, s += (*_p0)*(*_p0)); sum+=s;}),
+           1e6*best_time(nloop, [&]{sum += a.sumsq();}));
+    printf("%8ld %-12s %10.3f %10.3f\n", n, "trace",
+           1e6*best_time(nloop, [&]{double s=0; BINARY_OPTIMIZED_ITERATOR(const double, a, const double, b, s += (*_p0)*(*_p1)); sum+=s;}),
+           1e6*best_time(nloop, [&]{sum += a.trace(b);}));
+    printf("%8ld %-12s %10.3f %10.3f\n", n, "gaxpy",
+           1e6*best_time(nloop, [&]{BINARY_OPTIMIZED_ITERATOR(double, a, const double, b, *_p0 = 0.5*(*_p0) + 0.5*(*_p1));}),
+           1e6*best_time(nloop, [&]{a.gaxpy(0.5, b, 0.5);}));
+    printf("%8ld %-12s %10.3f %10.3f\n", n, "gaxpy_emul",
+           1e6*best_time(nloop, [&]{TERNARY_OPTIMIZED_ITERATOR(double, a, const double, b, const double, c, *_p0 = 0.5*(*_p0) + 0.5*(*_p1)*(*_p2));}),
+           1e6*best_time(nloop, [&]{a.gaxpy_emul(0.5, b, c, 0.5);}));
+    printf("%8ld %-12s %10.3f %10.3f\n", n, "screen",
+           1e6*best_time(nloop, [&]{UNARY_OPTIMIZED_ITERATOR(double, a, if (std::abs(*_p0)<1e-3) *_p0=0.0);}),
+           1e6*best_time(nloop, [&]{a.screen(1e-3);}));
+    if (sum == 0.1234) printf("unlikely\n"); // keep the reductions alive
+}
+
+int main(int argc, char** argv) {
+    if (getenv("MAD_SMALL_TESTS")) smalltest=true;
+    for (int iarg=1; iarg<argc; iarg++) if (strcmp(argv[iarg],"--small")==0) smalltest=true;
+    SafeMPI::Init_thread(argc, argv, MPI_THREAD_SINGLE);
+
+    for (long n : {0L, 1L, 3L, 7L, 8L, 15L, 16L, 17L, 33L, 216L, 1000L, 4096L}) {
+        test_kernels<double>(n);
+        test_kernels<double_complex>(n);
+        test_kernels<float>(n);
+    }
+
+    test_shapes();
+
+    if (nerror) {
+        printf("test_simd: %d errors\n", nerror);
+        SafeMPI::Finalize();
+        return 1;
+    }
+    printf("test_simd: kernels OK\n");
+
+    printf("\ntime per call (us)\n%8s %-12s %10s %10s\n", "n", "kernel", "macro", "simd");
+    for (long n : {216L, 1000L, 4096L}) time_kernels(n);
+
+    SafeMPI::Finalize();
+    return 0;
+}
@@ -415,6 +415,54 @@ namespace {
         ITERATOR3(b,ASSERT_EQ(b(_i,_j,_k), a(_j,_i,_k)));
     }
 
+    TYPED_TEST(TensorTest, BufferArchive) {
+        // Small tensors are copied, large ones gathered and adopted
+        for (long n : {10l, 3000l}) {
+            madness::Tensor<TypeParam> a(2,n), b(n);
+            a.fillrandom();
+            b.fillrandom();
+
+            madness::archive::BufferSegmentList segments;
+            madness::archive::BufferOutputArchive count(nullptr, 0, &segments);
+            count & a & b;
+            const std::size_t min_nbyte = madness::archive::BufferOutputArchive::min_segment_nbyte;
+            const bool large_a = a.size()*sizeof(TypeParam) >= min_nbyte;
+            const bool large_b = b.size()*sizeof(TypeParam) >= min_nbyte;
+            EXPECT_EQ(count.size_gathered(), (large_a ? a.size()*sizeof(TypeParam) : 0) + (large_b ? b.size()*sizeof(TypeParam) : 0));
+
+            // Place the gathered segments into the stream as the receiver would get it
+            const std::size_t nbyte = count.size();
+            void* mem = nullptr;
+            ASSERT_EQ(posix_memalign(&mem, 64, nbyte), 0);
+            std::shared_ptr<void> buf(mem, &std::free);
+            std::vector<unsigned char> inline_buf(nbyte - count.size_gathered());
+            madness::archive::BufferOutputArchive out(inline_buf.data(), inline_buf.size(), &segments);
+            out & a & b;
+            ASSERT_EQ(out.size(), nbyte);
+            ASSERT_EQ(segments.size(), std::size_t(large_a) + std::size_t(large_b));
+            std::size_t offset = 0, ninline = 0;
+            unsigned char* p = static_cast<unsigned char*>(buf.get());
+            for (const auto& seg : segments) {
+                EXPECT_EQ(seg.offset % madness::archive::BufferOutputArchive::segment_alignment, 0u);
+                std::memcpy(p + offset, inline_buf.data() + ninline, seg.offset - offset);
+                std::memcpy(p + seg.offset, seg.ptr, seg.nbyte);
+                ninline += seg.offset - offset;
+                offset = seg.offset + seg.nbyte;
+            }
+            std::memcpy(p + offset, inline_buf.data() + ninline, nbyte - offset);
+
+            madness::Tensor<TypeParam> c, d;
+            madness::archive::BufferInputArchive in(buf.get(), nbyte, buf);
+            in & c & d;
+            EXPECT_EQ(buf.use_count(), 2 + large_a + large_b); // the archive and adopted tensors
+            ASSERT_EQ(c.ndim(), 2);
+            ASSERT_EQ(c.dim(1), n);
+            ASSERT_EQ(d.size(), n);
+            ITERATOR2(c,ASSERT_EQ(c(IND2), a(IND2)));
+            ITERATOR1(d,ASSERT_EQ(d(IND1), b(IND1)));
+        }
+    }
+
 //     TYPED_TEST(TensorTest, Container) {
 //         typedef madness::ConcurrentHashMap< int, Tensor<TypeParam> > containerT;
 //         static const int N = 100;
@@ -0,0 +1,174 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/// \file test_tensor_am.cc
+/// \brief Sends small and large tensors between ranks by active message and by remote Future::set
+
+/// Tensors of 16 KB or more are gathered from their own memory when sent
+/// and, if they arrive in a buffer of their own (huge messages), adopted
+/// from it on receipt.  Every rank sends tensors of several sizes, some
+/// of them non-contiguous slices, to every rank, and asks every rank to
+/// return tensors through a remote future.  The received tensors are kept
+/// and checked again after the fence, after their buffers were released.
+
+#include <madness/world/MADworld.h>
+#include <madness/tensor/tensor.h>
+#include <atomic>
+#include <cstdio>
+#include <tuple>
+#include <vector>
+
+using namespace madness;
+
+/// The lengths sent: small, at the 16 KB threshold, large, and huge (longer than a recv buffer)
+static const long lengths[] = {10, 2048, 5000, 400000};
+
+/// Value of element j of the i-th tensor sent from src
+static double value(ProcessID src, long i, long j) {
+    return 1e7*src + 1e6*i + j;
+}
+
+/// The i-th tensor sent from src, as a 2-d tensor
+static Tensor<double> make_tensor(ProcessID src, long i) {
+    const long n = lengths[i%4];
+    Tensor<double> t(2, n/2);
+    double* p = t.ptr();
+    for (long j=0; j<t.size(); ++j) p[j] = value(src, i, j);
+    return t;
+}
+
+/// Number of elements of t that differ from make_tensor(src,i)
+static long check_tensor(const Tensor<double>& t, ProcessID src, long i) {
+    const Tensor<double> ref = make_tensor(src, i);
+    if (t.size() != ref.size() || t.ndim() != ref.ndim()) return 1;
+    const Tensor<double> tc = copy(t);   // Flat access also for slices
+    long nerr = 0;
+    for (long j=0; j<ref.size(); ++j) if (tc.ptr()[j] != ref.ptr()[j]) ++nerr;
+    return nerr;
+}
+
+class Sink : public WorldObject<Sink> {
+    Mutex mutex;
+    std::vector<std::tuple<ProcessID,long,Tensor<double>>> received;
+    std::atomic<long> nerror;
+public:
+    Sink(World& world) : WorldObject<Sink>(world), nerror(0) {
+        process_pending();
+    }
+
+    /// Handler of the one-way messages ... checks the tensor and keeps it
+    void recv(ProcessID src, long i, const Tensor<double>& t) {
+        nerror += check_tensor(t, src, i);
+        ScopedMutex<Mutex> lock(mutex);
+        received.emplace_back(src, i, t);
+    }
+
+    /// Handler that returns a tensor through a remote future
+    Tensor<double> make(long i) const {
+        return make_tensor(get_world().rank(), i);
+    }
+
+    /// Handler that returns a slice of a tensor, which is not contiguous
+    Tensor<double> make_slice(long i) const {
+        const Tensor<double> t = make_tensor(get_world().rank(), i);
+        return t(_,Slice(0,-1,2));
+    }
+
+    /// Checks again all tensors received, now that their buffers were released
+    long recheck(long nexpected) const {
+        long nerr = nerror;
+        if (long(received.size()) != nexpected) {
+            print(get_world().rank(), ": received", received.size(), "tensors, expected", nexpected);
+            ++nerr;
+        }
+        for (const auto& r : received) nerr += check_tensor(std::get<2>(r), std::get<0>(r), std::get<1>(r));
+        return nerr;
+    }
+};
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc, argv);
+    const ProcessID me = world.rank(), nproc = world.size();
+    const bool smalltest = (getenv("MAD_SMALL_TESTS") != nullptr);
+    const long nrep = smalltest ? 8 : 40;  // Tensors sent to each rank
+
+    long nerror = 0;
+    try {
+        Sink sink(world);
+        world.gop.fence();
+
+        // Active messages ... contiguous tensors, and slices that are copied when sent
+        for (long i=0; i<nrep; ++i) {
+            for (ProcessID dest=0; dest<nproc; ++dest) {
+                sink.send(dest, &Sink::recv, me, i, make_tensor(me, i));
+            }
+        }
+
+        // Remote futures ... the value is set by a message sent from the
+        // server thread of dest.  Only rank 0 asks for huge tensors, since
+        // server threads that send huge messages to each other at the same
+        // time wait for each other in the huge-message handshake.
+        std::vector<std::tuple<ProcessID,long,Future<Tensor<double>>>> futures;
+        for (long i=0; i<nrep; ++i) {
+            if (i%4 == 3 && me != 0) continue;
+            for (ProcessID dest=0; dest<nproc; ++dest) {
+                futures.emplace_back(dest, i, sink.send(dest, &Sink::make, i));
+            }
+        }
+        for (auto& f : futures) nerror += check_tensor(std::get<2>(f).get(), std::get<0>(f), std::get<1>(f));
+
+        for (long i=0; i<3; ++i) {   // Not huge, as above
+            const ProcessID dest = (me+1)%nproc;
+            const Tensor<double> t = sink.send(dest, &Sink::make_slice, i).get();
+            const Tensor<double> ref = make_tensor(dest, i)(_,Slice(0,-1,2));
+            if (t.size() != ref.size() || (t - ref).normf() != 0.0) ++nerror;
+        }
+        world.gop.fence();
+
+        nerror += sink.recheck(nrep*nproc);
+        world.gop.fence();
+    }
+    catch (const SafeMPI::Exception& e) {
+        print(e);
+        ++nerror;
+    }
+    catch (const madness::MadnessException& e) {
+        print(e);
+        ++nerror;
+    }
+
+    world.gop.sum(nerror);
+    if (me == 0) printf("test_tensor_am: %ld processes, %s\n", long(nproc), nerror ? "FAILED" : "OK");
+    world.gop.fence();
+
+    finalize();
+    return nerror ? 1 : 0;
+}
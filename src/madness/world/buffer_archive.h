@@ -42,6 +42,9 @@
 #include <madness/world/archive.h>
 #include <madness/world/print.h>
 #include <cstring>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace madness {
     namespace archive {
@@ -49,6 +52,20 @@ namespace madness {
         /// \addtogroup serialization
         /// @{
 
+        /// A large block of a serialized stream that is kept where it lives instead of being copied.
+
+        /// The block belongs at \c offset of the stream; \c owner keeps
+        /// the memory alive until the stream has been sent.
+        struct BufferSegment {
+            std::size_t offset; ///< Position of the block in the stream.
+            const void* ptr; ///< The block.
+            std::size_t nbyte; ///< Size of the block.
+            std::shared_ptr<const void> owner; ///< Keeps the block alive.
+        };
+
+        /// The gathered segments of a stream in order of increasing offset.
+        typedef std::vector<BufferSegment> BufferSegmentList;
+
         /// Wraps an archive around a memory buffer for output.
 
         /// \note Type checking is disabled for efficiency.
@@ -56,24 +73,57 @@ namespace madness {
         /// \throw madness::MadnessException in case of buffer overflow.
         ///
         /// The default constructor can also be used to count stuff.
+        ///
+        /// Large contiguous blocks stored with store_segment() are aligned
+        /// in the stream. An archive that gathers segments records them in
+        /// a \c BufferSegmentList instead of copying them, and the buffer
+        /// only holds the rest of the stream; the sender then transmits the
+        /// buffer and the segments together (see \c WorldAmInterface).
         class BufferOutputArchive : public BaseOutputArchive {
         private:
             unsigned char * const ptr; ///< The memory buffer.
             const std::size_t nbyte; ///< Buffer size.
             mutable std::size_t i; /// Current output location.
             bool countonly; ///< If true just count, don't copy.
+            BufferSegmentList* const segments; ///< Where to record gathered segments, if gathering.
+            mutable std::size_t ngathered; ///< Bytes of the stream held in segments.
+
+            /// Checks that \c m more bytes fit into the buffer and returns where they go.
+            unsigned char* reserve(std::size_t m) const {
+                const std::size_t j = i - ngathered;
+                if (j+m > nbyte) {
+                    madness::print("BufferOutputArchive:ptr,nbyte,i,m,i+m:",(void *)ptr,nbyte,j,m,j+m);
+                    MADNESS_ASSERT(j+m<=nbyte);
+                }
+                return ptr+j;
+            }
 
         public:
+            /// Blocks of at least this size are stored as segments.
+            static constexpr std::size_t min_segment_nbyte = 16384;
+
+            /// Alignment of segments in the stream.
+            static constexpr std::size_t segment_alignment = 64;
+
             /// Default constructor; the buffer will only count data.
             BufferOutputArchive()
-                    : ptr(nullptr), nbyte(0), i(0), countonly(true) {}
+                    : ptr(nullptr), nbyte(0), i(0), countonly(true), segments(nullptr), ngathered(0) {}
 
             /// Constructor that assigns a buffer.
 
             /// \param[in] ptr Pointer to the buffer.
             /// \param[in] nbyte Size of the buffer.
             BufferOutputArchive(void* ptr, std::size_t nbyte)
-                    : ptr((unsigned char *) ptr), nbyte(nbyte), i(0), countonly(false) {}
+                    : ptr((unsigned char *) ptr), nbyte(nbyte), i(0), countonly(false), segments(nullptr), ngathered(0) {}
+
+            /// Constructor for an archive that gathers segments.
+
+            /// \param[in] ptr Pointer to the buffer, or null to only count.
+            /// \param[in] nbyte Size of the buffer, excluding gathered segments.
+            /// \param[in] segments Where to record the gathered segments.
+            BufferOutputArchive(void* ptr, std::size_t nbyte, BufferSegmentList* segments)
+                    : ptr((unsigned char *) ptr), nbyte(nbyte), i(0), countonly(ptr == nullptr)
+                    , segments(segments), ngathered(0) {}
 
             /// Stores (counts) data into the memory buffer.
 
@@ -87,20 +137,47 @@ namespace madness {
             typename std::enable_if< madness::is_trivially_serializable<T>::value, void >::type
             store(const T* t, long n) const {
                 std::size_t m = n*sizeof(T);
-                if (countonly) {
-                    i += m;
-                }
-                else if (i+m > nbyte) {
-                    madness::print("BufferOutputArchive:ptr,nbyte,i,n,m,i+m:",(void *)ptr,nbyte,i,n,m,i+m);
-                    MADNESS_ASSERT(i+m<=nbyte);
-                }
-                else {
+                if (!countonly) {
+                    unsigned char* p = reserve(m);
 MADNESS_PRAGMA_GCC(diagnostic push)
 MADNESS_PRAGMA_GCC(diagnostic ignored "-Wmaybe-uninitialized")
-		  memcpy(ptr+i, t, m);
+		  memcpy(p, t, m);
 MADNESS_PRAGMA_GCC(diagnostic pop)
+                }
+                i += m;
+            }
+
+            /// Stores (counts) a contiguous block that may be sent without copying.
+
+            /// Blocks smaller than \c min_segment_nbyte are stored as with
+            /// store(). Larger ones start at a multiple of
+            /// \c segment_alignment in the stream and, if this archive
+            /// gathers segments, are recorded rather than copied.
+            /// \tparam T Type of the data to be stored (counted).
+            /// \param[in] t Pointer to the data to be stored (counted).
+            /// \param[in] n Size of data to be stored (counted).
+            /// \param[in] owner Keeps \c t alive while the segment is in use.
+            template <typename T>
+            inline
+            typename std::enable_if< std::is_trivially_copyable<T>::value, void >::type
+            store_segment(const T* t, long n, const std::shared_ptr<const void>& owner) const {
+                const std::size_t m = n*sizeof(T);
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(t);
+                if (m < min_segment_nbyte) {
+                    store(bytes, m);
+                    return;
+                }
+                const std::size_t npad = (segment_alignment - i%segment_alignment) % segment_alignment;
+                if (!countonly) std::memset(reserve(npad), 0, npad);
+                i += npad;
+                if (segments && owner) {
+                    if (!countonly) segments->push_back(BufferSegment{i, t, m, owner});
+                    ngathered += m;
                     i += m;
                 }
+                else {
+                    store(bytes, m);
+                }
             }
 
             /// Open a buffer with a specific size.
@@ -119,10 +196,16 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
 
             /// Return the amount of data stored (counted) in the buffer.
 
-            /// \return The amount of data stored (counted) in the buffer.
+            /// \return The amount of data stored (counted) in the buffer,
+            ///    including gathered segments.
             inline std::size_t size() const {
                 return i;
             };
+
+            /// Return the amount of data stored (counted) in gathered segments.
+            std::size_t size_gathered() const {
+                return ngathered;
+            }
         };
 
 
@@ -136,6 +219,15 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
             const unsigned char* const ptr; ///< The memory buffer.
             const std::size_t nbyte; ///< Buffer size.
             mutable std::size_t i; ///< Current input location.
+            std::shared_ptr<void> owner; ///< Owner of the buffer, if segments may be borrowed.
+
+            /// Skips the padding in front of a segment of \c m bytes.
+            void skip_segment_padding(std::size_t m) const {
+                if (m >= BufferOutputArchive::min_segment_nbyte) {
+                    constexpr std::size_t align = BufferOutputArchive::segment_alignment;
+                    i += (align - i%align) % align;
+                }
+            }
 
         public:
             /// Constructor that assigns a buffer.
@@ -145,6 +237,14 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
             BufferInputArchive(const void* ptr, std::size_t nbyte)
                     : ptr((const unsigned char *) ptr), nbyte(nbyte), i(0) {};
 
+            /// Constructor for a buffer whose segments may be kept by the objects read from it.
+
+            /// \param[in] ptr Pointer to the buffer.
+            /// \param[in] nbyte Size of the buffer.
+            /// \param[in] owner Owner of the memory that holds the buffer.
+            BufferInputArchive(const void* ptr, std::size_t nbyte, std::shared_ptr<void> owner)
+                    : ptr((const unsigned char *) ptr), nbyte(nbyte), i(0), owner(std::move(owner)) {};
+
             /// Reads data from the memory buffer.
 
             /// The function only appears (due to \c enable_if) if \c T is
@@ -162,6 +262,39 @@ MADNESS_PRAGMA_GCC(diagnostic pop)
                 i += m;
             }
 
+            /// Reads a block stored with BufferOutputArchive::store_segment().
+
+            /// \tparam T Type of the data to be read.
+            /// \param[out] t Where to store the read data.
+            /// \param[in] n Size of data to be read.
+            template <class T>
+            inline
+            typename std::enable_if< std::is_trivially_copyable<T>::value, void >::type
+            load_segment(T* t, long n) const {
+                skip_segment_padding(n*sizeof(T));
+                load(reinterpret_cast<unsigned char*>(t), n*sizeof(T));
+            }
+
+            /// Lends a block stored with BufferOutputArchive::store_segment() without copying it.
+
+            /// Succeeds only for segments of an archive constructed with an
+            /// owner; the result then shares ownership of the whole buffer.
+            /// \tparam T Type of the data to be read.
+            /// \param[in] n Size of data to be read.
+            /// \return Pointer to the data in the buffer, or null if the
+            ///    data must be read with load_segment().
+            template <class T>
+            std::shared_ptr<T> borrow_segment(long n) const {
+                const std::size_t m = n*sizeof(T);
+                if (!owner || m < BufferOutputArchive::min_segment_nbyte) return nullptr;
+                skip_segment_padding(m);
+                MADNESS_ASSERT(m+i <= nbyte);
+                T* p = (T*)(ptr+i);
+                if (reinterpret_cast<std::uintptr_t>(p) % BufferOutputArchive::segment_alignment) return nullptr;
+                i += m;
+                return std::shared_ptr<T>(owner, p);
+            }
+
             /// Open the archive.
             void open() {};
 
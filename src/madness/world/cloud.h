@@ -16,7 +16,9 @@
 
 
 #include <madness/world/parallel_dc_archive.h>
+#include<algorithm>
 #include<any>
+#include<cstring>
 #include<iomanip>
 
 
@@ -30,6 +32,63 @@
 
 namespace madness {
 
+namespace detail {
+
+#ifndef STUBOUTMPI
+/// a buffer allocated once per node in an MPI-3 shared memory window
+
+/// All processes of the node communicator map the same memory, which is allocated by the
+/// process with node rank 0. Construction and destruction are collective over the node.
+class NodeSharedBuffer {
+    SafeMPI::Intracomm nodecomm;
+    MPI_Win win;
+    unsigned char* base=nullptr;
+    std::size_t nbyte=0;
+
+public:
+    NodeSharedBuffer(const SafeMPI::Intracomm& nodecomm, const std::size_t nbyte)
+        : nodecomm(nodecomm), nbyte(nbyte) {
+        SAFE_MPI_GLOBAL_MUTEX;
+        const MPI_Aint mysize=(nodecomm.Get_rank()==0) ? std::max(nbyte,std::size_t(1)) : 0;
+        void* ptr=nullptr;
+        MADNESS_MPI_TEST(MPI_Win_allocate_shared(mysize,1,MPI_INFO_NULL,nodecomm.Get_mpi_comm(),&ptr,&win));
+        MPI_Aint size;
+        int disp_unit;
+        MADNESS_MPI_TEST(MPI_Win_shared_query(win,0,&size,&disp_unit,&ptr));
+        base=static_cast<unsigned char*>(ptr);
+        MADNESS_MPI_TEST(MPI_Win_lock_all(MPI_MODE_NOCHECK,win));
+    }
+
+    NodeSharedBuffer(const NodeSharedBuffer& other) = delete;
+    NodeSharedBuffer& operator=(const NodeSharedBuffer& other) = delete;
+
+    ~NodeSharedBuffer() {
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (finalized) return;
+        SAFE_MPI_GLOBAL_MUTEX;
+        MPI_Win_unlock_all(win);
+        MPI_Win_free(&win);
+    }
+
+    unsigned char* data() const {return base;}
+    std::size_t size() const {return nbyte;}
+
+    /// make local writes visible to all processes on the node (collective)
+    void sync() const {
+        {
+            SAFE_MPI_GLOBAL_MUTEX;
+            MADNESS_MPI_TEST(MPI_Win_sync(win));
+        }
+        nodecomm.Barrier();
+        SAFE_MPI_GLOBAL_MUTEX;
+        MADNESS_MPI_TEST(MPI_Win_sync(win));
+    }
+};
+#endif
+
+} // namespace detail
+
 template<typename keyT>
 struct Recordlist {
     std::list<keyT> list;
@@ -109,10 +168,15 @@ struct Recordlist {
 ///      do work
 ///  }
 ///  subworld.gop.fence();
+///
+/// Replication copies all records to every process. By default the records are placed in a
+/// shared memory window, so only one read-only copy exists per node, and loading deserializes
+/// directly from the shared memory.
 class Cloud {
 
     bool debug = false;       ///< prints debug output
     bool is_replicated=false;   ///< if contents of the container are replicated
+    bool use_shared_memory = true;    ///< replicate into one copy per node instead of one per process
     bool dofence = true;      ///< fences after load/store
     bool force_load_from_cache = false;       ///< forces load from cache (mainly for debugging)
 
@@ -128,6 +192,10 @@ private:
     madness::WorldContainer<keyT, valueT> container;
     cacheT cached_objects;
     recordlistT local_list_of_container_keys;   // a world-local list of keys occupied in container
+#ifndef STUBOUTMPI
+    std::shared_ptr<detail::NodeSharedBuffer> shared_buffer;   ///< replicated records, one copy per node
+#endif
+    std::map<keyT,std::pair<std::size_t,std::size_t>> shared_records;  ///< offset and size in shared_buffer
 
 public:
 
@@ -148,6 +216,11 @@ public:
         force_load_from_cache = value;
     }
 
+    /// replicate into node-shared memory (if MPI is available) or into every process
+    void set_use_shared_memory(bool value) {
+        use_shared_memory = value;
+    }
+
     void print_size(World& universe) {
 
         std::size_t memsize=0;
@@ -163,10 +236,16 @@ public:
         auto global_size=local_size;
         universe.gop.sum(global_size);
         double byte2gbyte=1.0/(1024*1024*1024);
+        std::size_t shared_memsize=shared_size();
 
         if (universe.rank()==0) {
             print("Cloud memory:");
             print("  replicated:",is_replicated);
+            if (shared_records.size()>0) {
+                print("  replicated in node-shared memory");
+                print("  number of records:",shared_records.size());
+                print("  memory in GBytes per node: ",shared_memsize*byte2gbyte);
+            }
             print("size of cloud (total)");
             print("  number of records:",global_size);
             print("  memory in GBytes: ",global_memsize*byte2gbyte);
@@ -214,6 +293,17 @@ public:
         cache_reads=0l;
     }
 
+    /// forget the node-shared records of a replication and free their window
+
+    /// collective over all processes of the universe, since the window is freed. Called
+    /// by replicate() and by the MacroTaskQ once all tasks have run.
+    void clear_shared_records() {
+        shared_records.clear();
+#ifndef STUBOUTMPI
+        shared_buffer.reset();
+#endif
+    }
+
     template<typename T>
     T load(madness::World &world, const recordlistT recordlist) const {
         recordlistT rlist = recordlist;
@@ -246,9 +336,17 @@ public:
 
         World& world=container.get_world();
         cloudtimer t(world,replication_time);
+        clear_shared_records();     // the cloud may be replicated again, with or without shared memory
         container.reset_pmap_to_local();
         is_replicated=true;
 
+#ifndef STUBOUTMPI
+        if (use_shared_memory) {
+            replicate_to_shared_memory(chunk_size);
+            return;
+        }
+#endif
+
         std::list<keyT> keylist;
         for (auto it=container.begin(); it!=container.end(); ++it) {
             keylist.push_back(it->first);
@@ -301,6 +399,110 @@ public:
 
 private:
 
+    /// size of the node-shared replicated records in bytes
+    std::size_t shared_size() const {
+#ifndef STUBOUTMPI
+        if (shared_buffer) return shared_buffer->size();
+#endif
+        return 0;
+    }
+
+#ifndef STUBOUTMPI
+    /// replicate all records into a single shared memory window per node
+
+    /// every process writes its own records into the window of its node, then the node
+    /// leaders exchange the records among themselves. The container itself is not replicated.
+    /// The records are laid out node by node, so that the record lists are gathered with one
+    /// Allgather and one Allgatherv, and the payload with one Allgatherv among the leaders
+    /// (or a few, if a node holds more than chunk_size bytes).
+    void replicate_to_shared_memory(const std::size_t chunk_size) {
+        World& world=container.get_world();
+        const int nproc=world.size();
+        SafeMPI::Intracomm nodecomm=world.mpi.comm().Split_type(SafeMPI::Intracomm::SHARED_SPLIT_TYPE, world.rank());
+        const bool is_leader=(nodecomm.Get_rank()==0);
+        SafeMPI::Intracomm leadercomm=world.mpi.comm().Split(
+                is_leader ? 0 : SafeMPI::Intracomm::UNDEFINED_COLOR, world.rank());
+        int my_leader=is_leader ? leadercomm.Get_rank() : 0;
+        nodecomm.Bcast(&my_leader,1,MPI_INT,0);
+        int nleader=is_leader ? leadercomm.Get_size() : 0;
+        nodecomm.Bcast(&nleader,1,MPI_INT,0);
+
+        // announce the local records: key, size and the leader of the owner's node
+        struct recordinfo {
+            keyT key;
+            std::size_t size;
+            int leader;
+        };
+        std::vector<recordinfo> local_records;
+        for (auto it=container.begin(); it!=container.end(); ++it) {
+            local_records.push_back(recordinfo{it->first,it->second.size(),my_leader});
+        }
+        const int nlocal=local_records.size();
+        std::vector<int> nrecords(nproc);
+        world.mpi.Allgather(&nlocal,sizeof(int),MPI_BYTE,nrecords.data(),sizeof(int),MPI_BYTE);
+        std::vector<int> counts(nproc), displs(nproc);
+        std::size_t nrecord=0;
+        for (int p=0; p<nproc; ++p) {
+            counts[p]=nrecords[p]*sizeof(recordinfo);
+            displs[p]=nrecord*sizeof(recordinfo);
+            nrecord+=nrecords[p];
+        }
+        std::vector<recordinfo> all_records(nrecord);
+        world.mpi.Allgatherv(local_records.data(),nlocal*sizeof(recordinfo),MPI_BYTE,
+                             all_records.data(),counts.data(),displs.data(),MPI_BYTE);
+
+        // records of one node are contiguous; node blocks start at a multiple of
+        // alignment bytes, which is the unit of the payload exchange
+        constexpr std::size_t alignment=64;
+        std::stable_sort(all_records.begin(),all_records.end(),
+                         [](const recordinfo& a, const recordinfo& b) {return a.leader<b.leader;});
+        std::vector<std::size_t> block_start(nleader+1,0);
+        clear_shared_records();
+        std::size_t offset=0;
+        for (int l=0, i=0; l<nleader; ++l) {
+            offset=(offset+alignment-1)/alignment*alignment;
+            block_start[l]=offset;
+            for (; i<int(nrecord) && all_records[i].leader==l; ++i) {
+                shared_records[all_records[i].key]=std::make_pair(offset,all_records[i].size);
+                offset+=all_records[i].size;
+            }
+        }
+        offset=(offset+alignment-1)/alignment*alignment;
+        block_start[nleader]=offset;
+        shared_buffer.reset(new detail::NodeSharedBuffer(nodecomm,offset));
+        unsigned char* base=shared_buffer->data();
+
+        // copy the local records into the window of this node
+        for (auto it=container.begin(); it!=container.end(); ++it) {
+            std::memcpy(base+shared_records[it->first].first, it->second.data(), it->second.size());
+        }
+        shared_buffer->sync();
+
+        // distribute the node blocks among the leaders, at most chunk_size bytes per block and round
+        if (is_leader and nleader>1) {
+            MPI_Datatype unit=SafeMPI::Type_contiguous_bytes(alignment);
+            const long chunk=std::max(std::size_t(1),chunk_size/alignment);
+            long nround=0;
+            for (int l=0; l<nleader; ++l) {
+                const long nunit=(block_start[l+1]-block_start[l])/alignment;
+                nround=std::max(nround,(nunit+chunk-1)/chunk);
+            }
+            std::vector<int> ucounts(nleader), udispls(nleader);
+            for (long r=0; r<nround; ++r) {
+                for (int l=0; l<nleader; ++l) {
+                    const long nunit=(block_start[l+1]-block_start[l])/alignment;
+                    ucounts[l]=std::max(0l,std::min(chunk,nunit-r*chunk));
+                    udispls[l]=block_start[l]/alignment+std::min(r*chunk,nunit);
+                }
+                leadercomm.Allgatherv(MPI_IN_PLACE,0,MPI_DATATYPE_NULL,base,ucounts.data(),udispls.data(),unit);
+            }
+            SafeMPI::Type_free(unit);
+        }
+        shared_buffer->sync();
+        world.gop.fence();
+    }
+#endif
+
     mutable std::atomic<long> reading_time=0l;    // in ms
     mutable std::atomic<long> writing_time=0l;    // in ms
     mutable std::atomic<long> replication_time=0l;    // in ms
@@ -415,8 +617,20 @@ private:
         if (force_load_from_cache) MADNESS_CHECK(is_cached(record));
 
         if (is_cached(record)) return load_from_cache<T>(world, record);
-        if (debug) print("loading", typeid(T).name(), "from container record", record, "to world", world.id());
         T target = allocator<T>(world);
+#ifndef STUBOUTMPI
+        auto it=shared_records.find(record);
+        if (it!=shared_records.end()) {
+            if (debug) print("loading", typeid(T).name(), "from shared record", record, "to world", world.id());
+            const unsigned char* ptr=shared_buffer->data()+it->second.first;
+            madness::archive::ContainerRecordInputArchive ar(world, ptr, it->second.second);
+            madness::archive::ParallelInputArchive<madness::archive::ContainerRecordInputArchive> par(world, ar);
+            par & target;
+            cache(world, target, record);
+            return target;
+        }
+#endif
+        if (debug) print("loading", typeid(T).name(), "from container record", record, "to world", world.id());
         madness::archive::ContainerRecordInputArchive ar(world, container, record);
         madness::archive::ParallelInputArchive<madness::archive::ContainerRecordInputArchive> par(world, ar);
         par & target;
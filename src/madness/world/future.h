@@ -47,6 +47,7 @@
 #include <madness/world/stack.h>
 #include <madness/world/worldref.h>
 #include <madness/world/world.h>
+#include <madness/world/slab_allocator.h>
 
 /// \addtogroup futures
 /// @{
@@ -388,25 +389,46 @@ namespace madness {
         /// \param[in] blah Description needed.
         explicit Future(const dddd& blah) : f(), value(nullptr) { }
 
+        /// Makes a new implementation object.
+
+        /// The implementation and the \c shared_ptr control block share a
+        /// single allocation from the slab allocator.
+        /// \param[in] args Arguments of the \c FutureImpl constructor.
+        /// \return Shared pointer to the new implementation.
+        template <typename... argT>
+        static std::shared_ptr< FutureImpl<T> > make_impl(argT&&... args) {
+            return std::allocate_shared< FutureImpl<T> >(
+                    detail::SlabStdAllocator< FutureImpl<T> >(), std::forward<argT>(args)...);
+        }
+
     public:
         /// \todo Brief description needed.
         typedef RemoteReference< FutureImpl<T> > remote_refT;
 
         /// Makes an unassigned future.
         Future() :
-            f(new FutureImpl<T>()), value(nullptr)
+            f(make_impl()), value(nullptr)
         {
         }
 
         /// Makes an assigned future.
 
-        /// \todo Description needed.
-        /// \param[in] t Description needed.
+        /// The value is held inline, no implementation object is made.
+        /// \param[in] t The value.
         explicit Future(const T& t) :
             f(), value(new(static_cast<void*>(buffer)) T(t))
         {
         }
 
+        /// Makes an assigned future, moving the value in.
+
+        /// The value is held inline, no implementation object is made.
+        /// \param[in] t The value.
+        explicit Future(T&& t) :
+            f(), value(new(static_cast<void*>(buffer)) T(std::move(t)))
+        {
+        }
+
 
         /// Makes a future wrapping a remote reference.
 
@@ -414,7 +436,7 @@ namespace madness {
         explicit Future(const remote_refT& remote_ref) :
                 f(remote_ref.is_local() ?
                         remote_ref.get_shared() :
-                        std::make_shared<FutureImpl<T> >(remote_ref)),
+                        make_impl(remote_ref)),
                 //                        std::shared_ptr<FutureImpl<T> >(new FutureImpl<T>(remote_ref))),
                 value(nullptr)
         {
@@ -441,7 +463,7 @@ namespace madness {
                 nullptr)
         {
             if(other.is_default_initialized())
-                f.reset(new FutureImpl<T>()); // Other was default constructed so make a new f
+                f = make_impl(); // Other was default constructed so make a new f
         }
 
         /// Destructor.
@@ -4,6 +4,7 @@
 #include <madness/world/MADworld.h>
 #include <madness/world/worlddc.h>
 #include <madness/world/vector_archive.h>
+#include <madness/world/buffer_archive.h>
 
 namespace madness {
 
@@ -54,31 +55,27 @@ namespace madness {
             }
         };
         
+        /// read a record from a container, or from a raw (e.g. node-shared) buffer without copying it
         class ContainerRecordInputArchive : public BaseInputArchive {
             using keyT = long;
             using containerT = WorldContainer<keyT,std::vector<unsigned char>>;
             ProcessID rank;
-            std::vector<unsigned char> v;
-            VectorInputArchive ar;
+            containerT::const_iterator it;     ///< holds the record (a copy if it is remote)
+            BufferInputArchive ar;
             
         public:
             ContainerRecordInputArchive(World& subworld, const containerT& dc, const keyT& key)
                 : rank(subworld.rank())
-                , v()
-                , ar(v)
-            {
-                if (rank==0) {
-                    containerT::const_iterator it = dc.find(key).get();
-                    if (it != dc.end()) {
-                        v = it->second;
-                    }
-                    else {
-                    	std::cout << "key " << key << " in world " << subworld.id()
-                    			<< "dc.world " << dc.get_world().id() << std::endl;
-                        MADNESS_EXCEPTION("record not found", key);
-                    }
-                }
-            }
+                , it()
+                , ar(find_record(subworld,dc,key))
+            {}
+
+            /// read from a buffer owned by someone else, e.g. the node-shared memory of the cloud
+            ContainerRecordInputArchive(World& subworld, const unsigned char* ptr, const std::size_t nbyte)
+                : rank(subworld.rank())
+                , it()
+                , ar(ptr,nbyte)
+            {}
             
             ~ContainerRecordInputArchive()
             {}
@@ -96,6 +93,19 @@ namespace madness {
             void flush() {}
             
             void close() {}
+
+        private:
+            /// find the record on subworld rank 0 and return the buffer holding it
+            BufferInputArchive find_record(World& subworld, const containerT& dc, const keyT& key) {
+                if (rank!=0) return BufferInputArchive(nullptr,0);
+                it = dc.find(key).get();
+                if (it == dc.end()) {
+                    std::cout << "key " << key << " in world " << subworld.id()
+                            << "dc.world " << dc.get_world().id() << std::endl;
+                    MADNESS_EXCEPTION("record not found", key);
+                }
+                return BufferInputArchive(it->second.data(),it->second.size());
+            }
         };
         
     }
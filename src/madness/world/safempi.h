@@ -100,6 +100,7 @@ namespace SafeMPI {
     /// tags in [8192,MPI::TAG_UB] ... not used/managed by madness
 
     static const int RMI_TAG = 1023;
+    static const int RMI_WAKE_TAG = 1022;
     static const int MPIAR_TAG = 1001;
     static const int DEFAULT_SEND_RECV_TAG = 1000;
 
@@ -383,6 +384,27 @@ namespace SafeMPI {
             return outcount;
         }
 
+        static int Waitsome(int incount, Request* requests, int* indices, Status* statuses) {
+            MADNESS_ASSERT(requests != nullptr);
+            MADNESS_ASSERT(indices != nullptr);
+            MADNESS_ASSERT(statuses != nullptr);
+
+            int outcount = 0;
+            std::unique_ptr<MPI_Request[]> mpi_requests(new MPI_Request[incount]);
+            std::unique_ptr<MPI_Status[]> mpi_statuses(new MPI_Status[incount]);
+            for(int i = 0; i < incount; ++i)
+                mpi_requests[i] = requests[i].request_;
+            {
+                SAFE_MPI_GLOBAL_MUTEX;
+                MADNESS_MPI_TEST(MPI_Waitsome(incount, mpi_requests.get(), &outcount, indices, mpi_statuses.get()));
+            }
+            for(int i = 0; i < incount; ++i) {
+                requests[i] = mpi_requests[i];
+                statuses[i] = mpi_statuses[i];
+            }
+            return (outcount == MPI_UNDEFINED) ? 0 : outcount;
+        }
+
         static int Testsome(int incount, Request* requests, int* indices) {
             int outcount = 0;
             std::unique_ptr<MPI_Request[]> mpi_requests(new MPI_Request[incount]);
@@ -780,6 +802,27 @@ namespace SafeMPI {
             SAFE_MPI_GLOBAL_MUTEX;
             MADNESS_MPI_TEST(MPI_Allreduce(const_cast<void*>(sendbuf), recvbuf, count, datatype, op, pimpl->comm));
         }
+
+        void Allgather(const void* sendbuf, const int sendcount, const MPI_Datatype sendtype, void* recvbuf, const int recvcount, const MPI_Datatype recvtype) const {
+            MADNESS_ASSERT(pimpl);
+            SAFE_MPI_GLOBAL_MUTEX;
+            MADNESS_MPI_TEST(MPI_Allgather(const_cast<void*>(sendbuf), sendcount, sendtype, recvbuf, recvcount, recvtype, pimpl->comm));
+        }
+
+        void Allgatherv(const void* sendbuf, const int sendcount, const MPI_Datatype sendtype, void* recvbuf, const int recvcounts[], const int displs[], const MPI_Datatype recvtype) const {
+            MADNESS_ASSERT(pimpl);
+            SAFE_MPI_GLOBAL_MUTEX;
+            MADNESS_MPI_TEST(MPI_Allgatherv(const_cast<void*>(sendbuf), sendcount, sendtype, recvbuf, const_cast<int*>(recvcounts), const_cast<int*>(displs), recvtype, pimpl->comm));
+        }
+
+        Request Iallreduce(const void* sendbuf, void* recvbuf, const int count, const MPI_Datatype datatype, const MPI_Op op) const {
+            MADNESS_ASSERT(pimpl);
+            SAFE_MPI_GLOBAL_MUTEX;
+            Request request;
+            MADNESS_MPI_TEST(MPI_Iallreduce(const_cast<void*>(sendbuf), recvbuf, count, datatype, op, pimpl->comm, request));
+            return request;
+        }
+
         bool Get_attr(int key, void* value) const {
             MADNESS_ASSERT(pimpl);
             int flag = 0;
@@ -942,6 +985,48 @@ namespace SafeMPI {
       MADNESS_MPI_TEST(MPI_Op_free(&op));
     }
 
+    /// Analogous to MPI_Get_address
+    inline MPI_Aint Get_address(const void* location) {
+      MPI_Aint result;
+      MADNESS_MPI_TEST(MPI_Get_address(const_cast<void*>(location), &result));
+      return result;
+    }
+
+    /// Creates and commits a datatype of \c count byte blocks at absolute addresses
+
+    /// Analogous to MPI_Type_create_hindexed of MPI_BYTE followed by
+    /// MPI_Type_commit; use with MPI_BOTTOM as the buffer address.
+    /// \param count The number of blocks
+    /// \param lengths The length of each block in bytes
+    /// \param addresses The address of each block (see Get_address())
+    /// \return The committed datatype ... free with Type_free()
+    inline MPI_Datatype Type_create_hindexed_bytes(int count, const int lengths[], const MPI_Aint addresses[]) {
+      MPI_Datatype result;
+      SAFE_MPI_GLOBAL_MUTEX;
+      MADNESS_MPI_TEST(MPI_Type_create_hindexed(count, const_cast<int*>(lengths), const_cast<MPI_Aint*>(addresses), MPI_BYTE, &result));
+      MADNESS_MPI_TEST(MPI_Type_commit(&result));
+      return result;
+    }
+
+    /// Creates and commits a datatype of \c nbyte contiguous bytes
+
+    /// Analogous to MPI_Type_contiguous of MPI_BYTE followed by MPI_Type_commit;
+    /// counts and displacements in units of this type reach beyond INT_MAX bytes.
+    /// \return The committed datatype ... free with Type_free()
+    inline MPI_Datatype Type_contiguous_bytes(int nbyte) {
+      MPI_Datatype result;
+      SAFE_MPI_GLOBAL_MUTEX;
+      MADNESS_MPI_TEST(MPI_Type_contiguous(nbyte, MPI_BYTE, &result));
+      MADNESS_MPI_TEST(MPI_Type_commit(&result));
+      return result;
+    }
+
+    /// Analogous to MPI_Type_free ... pending communication using the type is not affected
+    inline void Type_free(MPI_Datatype type) {
+      SAFE_MPI_GLOBAL_MUTEX;
+      MADNESS_MPI_TEST(MPI_Type_free(&type));
+    }
+
 } // namespace SafeMPI
 
 #endif // MADNESS_WORLD_SAFEMPI_H__INCLUDED
@@ -0,0 +1,178 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/**
+ \file slab_allocator.cc
+ \brief Global pool and slow paths of the slab allocator
+ \ingroup threads
+*/
+
+#include <madness/world/slab_allocator.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace madness {
+
+    namespace detail {
+
+        namespace {
+
+            /// Blocks released by threads, shared by all threads
+            struct GlobalPool {
+                std::mutex mutex;
+                void* head[SlabAllocator::nclass] = {};
+                std::atomic<std::size_t> nslab{0};
+                std::atomic<std::size_t> nbyte{0};
+            };
+
+            // Never destroyed, since threads may release blocks during exit
+            GlobalPool& global_pool() {
+                static GlobalPool* pool = new GlobalPool;
+                return *pool;
+            }
+
+            // Every slab holds at least this many bytes
+            const std::size_t SLAB_SIZE = 64*1024;
+
+            inline void*& next(void* b) { return *static_cast<void**>(b); }
+
+        } // namespace
+
+
+        void* SlabAllocator::refill(ThreadCache* c, std::size_t i) {
+            const std::size_t blocksize = (i+1)*granularity;
+            GlobalPool& pool = global_pool();
+
+            // Take up to half a cache worth of blocks from the global pool
+            void* head = nullptr;
+            std::size_t n = 0;
+            {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                head = pool.head[i];
+                void* tail = head;
+                if (head) {
+                    n = 1;
+                    while (next(tail) && n < max_cached/2) {
+                        tail = next(tail);
+                        ++n;
+                    }
+                    pool.head[i] = next(tail);
+                    next(tail) = nullptr;
+                }
+            }
+
+            // ... or carve a new slab
+            if (!head) {
+                n = std::max<std::size_t>(16, SLAB_SIZE/blocksize);
+                char* slab = static_cast<char*>(::operator new(n*blocksize, std::align_val_t(granularity)));
+                pool.nslab++;
+                pool.nbyte += n*blocksize;
+                for (std::size_t j=0; j<n; ++j)
+                    next(slab + j*blocksize) = (j+1<n) ? slab + (j+1)*blocksize : nullptr;
+                head = slab;
+            }
+
+            void* result = head;
+            head = next(head);
+            --n;
+            if (c) {
+                c->head[i] = static_cast<Block*>(head);
+                c->n[i] = n;
+            }
+            else if (head) {
+                // The thread is exiting, so hand the rest straight back
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                void* tail = head;
+                while (next(tail)) tail = next(tail);
+                next(tail) = pool.head[i];
+                pool.head[i] = head;
+            }
+            return result;
+        }
+
+
+        void SlabAllocator::spill(ThreadCache* c, std::size_t i) {
+            // Keep the most recently freed half, which is more likely in cache
+            Block* tail = c->head[i];
+            const std::size_t nkeep = c->n[i]/2;
+            for (std::size_t j=1; j<nkeep; ++j) tail = tail->next;
+            Block* first = tail->next;
+            tail->next = nullptr;
+
+            Block* last = first;
+            while (last->next) last = last->next;
+
+            GlobalPool& pool = global_pool();
+            {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                last->next = static_cast<Block*>(pool.head[i]);
+                pool.head[i] = first;
+            }
+            c->n[i] = nkeep;
+        }
+
+
+        void SlabAllocator::release(Block* b, std::size_t i) {
+            GlobalPool& pool = global_pool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            b->next = static_cast<Block*>(pool.head[i]);
+            pool.head[i] = b;
+        }
+
+
+        SlabAllocator::ThreadCache::~ThreadCache() {
+            GlobalPool& pool = global_pool();
+            {
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                for (std::size_t i=0; i<nclass; ++i) {
+                    if (!head[i]) continue;
+                    Block* last = head[i];
+                    while (last->next) last = last->next;
+                    last->next = static_cast<Block*>(pool.head[i]);
+                    pool.head[i] = head[i];
+                    head[i] = nullptr;
+                    n[i] = 0;
+                }
+            }
+            current = nullptr;
+            destroyed = true;
+        }
+
+
+        SlabAllocator::Statistics SlabAllocator::get_statistics() {
+            const GlobalPool& pool = global_pool();
+            return Statistics{pool.nslab.load(), pool.nbyte.load()};
+        }
+
+    } // namespace detail
+
+} // namespace madness
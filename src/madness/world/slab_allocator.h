@@ -0,0 +1,164 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+#ifndef MADNESS_WORLD_SLAB_ALLOCATOR_H__INCLUDED
+#define MADNESS_WORLD_SLAB_ALLOCATOR_H__INCLUDED
+
+/**
+ \file slab_allocator.h
+ \brief Per-thread slab allocation of small runtime objects (tasks, futures, active messages)
+ \ingroup threads
+*/
+
+#include <cstddef>
+#include <new>
+
+namespace madness {
+
+    namespace detail {
+
+        /// Per-thread slab allocator for the small, short-lived objects of the runtime
+
+        /// Tree algorithms create and destroy millions of tasks, future
+        /// implementations and active message buffers per second, each of
+        /// which used to be a separate \c malloc/free pair. Requests of up to
+        /// \c max_size bytes are rounded up to a multiple of \c granularity
+        /// and served from a free list of the calling thread; blocks are
+        /// carved out of large slabs. Since objects are typically created by
+        /// one thread and destroyed by another, a thread that caches more than
+        /// \c max_cached blocks of one size returns half of them to a global
+        /// pool, from which empty threads refill. Slabs are never returned to
+        /// the system. Larger requests go straight to \c ::operator \c new.
+        class SlabAllocator {
+        public:
+            static constexpr std::size_t granularity = 64;  ///< Block sizes (and alignment) are multiples of this
+            static constexpr std::size_t nclass = 32;       ///< Number of size classes
+            static constexpr std::size_t max_size = granularity*nclass; ///< Largest pooled request in bytes
+            static constexpr std::size_t max_cached = 1024; ///< Blocks per size class a thread keeps
+
+            /// Counters of the slab allocator
+            struct Statistics {
+                std::size_t nslab;  ///< Number of slabs obtained from the system
+                std::size_t nbyte;  ///< Total size of the slabs in bytes
+            };
+
+        private:
+            struct Block { Block* next; };
+
+            struct ThreadCache {
+                Block* head[nclass] = {};
+                std::size_t n[nclass] = {};
+                ThreadCache() { current = this; }
+                ~ThreadCache();
+            };
+
+            static inline thread_local ThreadCache* current = nullptr;
+            static inline thread_local bool destroyed = false;
+
+            /// The cache of the calling thread, or null while the thread exits
+            static ThreadCache* cache() {
+                if (current) return current;
+                if (destroyed) return nullptr;
+                thread_local ThreadCache c;
+                return &c;
+            }
+
+            static void* refill(ThreadCache* c, std::size_t i);
+            static void spill(ThreadCache* c, std::size_t i);
+            static void release(Block* b, std::size_t i);
+
+        public:
+
+            /// Allocates \c size bytes, aligned to at least \c granularity if pooled
+            static void* allocate(std::size_t size) {
+                if (size > max_size) return ::operator new(size);
+                const std::size_t i = (size==0) ? 0 : (size-1)/granularity;
+                ThreadCache* c = cache();
+                Block* b = c ? c->head[i] : nullptr;
+                if (!b) return refill(c, i);
+                c->head[i] = b->next;
+                --(c->n[i]);
+                return b;
+            }
+
+            /// Frees memory obtained from allocate() ... \c size must be the size requested
+            static void deallocate(void* p, std::size_t size) noexcept {
+                if (!p) return;
+                if (size > max_size) {
+                    ::operator delete(p);
+                    return;
+                }
+                const std::size_t i = (size==0) ? 0 : (size-1)/granularity;
+                Block* b = static_cast<Block*>(p);
+                ThreadCache* c = cache();
+                if (!c) {
+                    release(b, i);
+                    return;
+                }
+                b->next = c->head[i];
+                c->head[i] = b;
+                if (++(c->n[i]) > max_cached) spill(c, i);
+            }
+
+            /// Returns the slab counters of this process
+            static Statistics get_statistics();
+        };
+
+        /// Standard allocator on top of SlabAllocator, e.g.\ for \c std::allocate_shared
+        template <typename T>
+        struct SlabStdAllocator {
+            typedef T value_type;
+
+            SlabStdAllocator() = default;
+
+            template <typename U>
+            SlabStdAllocator(const SlabStdAllocator<U>&) {}
+
+            T* allocate(std::size_t n) {
+                return static_cast<T*>(SlabAllocator::allocate(n*sizeof(T)));
+            }
+
+            void deallocate(T* p, std::size_t n) noexcept {
+                SlabAllocator::deallocate(p, n*sizeof(T));
+            }
+
+            template <typename U>
+            bool operator==(const SlabStdAllocator<U>&) const { return true; }
+
+            template <typename U>
+            bool operator!=(const SlabStdAllocator<U>&) const { return false; }
+        };
+
+    } // namespace detail
+
+} // namespace madness
+
+#endif // MADNESS_WORLD_SLAB_ALLOCATOR_H__INCLUDED
@@ -151,6 +151,11 @@ inline int MPI_Testsome(int, MPI_Request*, int *outcount, int*, MPI_Status*) {
     return MPI_SUCCESS;
 }
 
+inline int MPI_Waitsome(int, MPI_Request*, int *outcount, int*, MPI_Status*) {
+    *outcount = MPI_UNDEFINED;
+    return MPI_SUCCESS;
+}
+
 inline int MPI_Get_count(MPI_Status *, MPI_Datatype, int *count) {
     *count = 0;
     return MPI_SUCCESS;
@@ -182,6 +187,22 @@ inline int MPI_Allreduce(void *sendbuf, void *recvbuf, int count, MPI_Datatype,
     return MPI_SUCCESS;
 }
 
+// Allgather and Allgatherv do memcpy and return MPI_SUCCESS
+inline int MPI_Allgather(void *sendbuf, int sendcount, MPI_Datatype, void *recvbuf, int, MPI_Datatype, MPI_Comm) {
+    if(sendbuf != MPI_IN_PLACE) std::memcpy(recvbuf, sendbuf, sendcount);
+    return MPI_SUCCESS;
+}
+inline int MPI_Allgatherv(void *sendbuf, int sendcount, MPI_Datatype, void *recvbuf, int*, int* displs, MPI_Datatype, MPI_Comm) {
+    if(sendbuf != MPI_IN_PLACE) std::memcpy(static_cast<char*>(recvbuf) + displs[0], sendbuf, sendcount);
+    return MPI_SUCCESS;
+}
+
+inline int MPI_Iallreduce(void *sendbuf, void *recvbuf, int count, MPI_Datatype, MPI_Op, MPI_Comm, MPI_Request* request) {
+    if(sendbuf != MPI_IN_PLACE) std::memcpy(recvbuf, sendbuf, count);
+    *request = MPI_REQUEST_NULL;
+    return MPI_SUCCESS;
+}
+
 inline int MPI_Comm_get_attr(MPI_Comm, int, void*, int*) { return MPI_ERR_COMM; }
 
 inline int MPI_Comm_split(MPI_Comm comm, int color, int key, MPI_Comm *newcomm) {
@@ -259,6 +280,31 @@ inline int MPI_Op_free(MPI_Op *op) {
   return MPI_SUCCESS;
 }
 
+typedef std::ptrdiff_t MPI_Aint;
+#define MPI_BOTTOM ((void *) 0)
+
+inline int MPI_Get_address(const void *location, MPI_Aint *address) {
+  *address = reinterpret_cast<MPI_Aint>(location);
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Type_create_hindexed(int, const int[], const MPI_Aint[], MPI_Datatype, MPI_Datatype *newtype) {
+  *newtype = MPI_DATATYPE_NULL;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Type_contiguous(int, MPI_Datatype, MPI_Datatype *newtype) {
+  *newtype = MPI_DATATYPE_NULL;
+  return MPI_SUCCESS;
+}
+
+inline int MPI_Type_commit(MPI_Datatype *) { return MPI_SUCCESS; }
+
+inline int MPI_Type_free(MPI_Datatype *type) {
+  *type = MPI_DATATYPE_NULL;
+  return MPI_SUCCESS;
+}
+
 inline int MPI_Info_create (MPI_Info *info) { return MPI_SUCCESS; }
 inline int MPI_Info_free (MPI_Info *info) { return MPI_SUCCESS; }
 
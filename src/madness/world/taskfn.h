@@ -37,6 +37,7 @@
 #include <madness/world/thread.h>
 #include <madness/world/future.h>
 #include <madness/world/meta.h>
+#include <madness/world/slab_allocator.h>
 
 #define MADNESS_TASKQ_VARIADICS 1
 
@@ -151,6 +152,16 @@ namespace madness {
 
         World* get_world() const { return const_cast<World*>(world); }
 
+        /// Tasks are allocated by the slab allocator of the creating thread
+        static void* operator new(std::size_t size) {
+            return detail::SlabAllocator::allocate(size);
+        }
+
+        /// Sized delete, called with the size of the most derived task type
+        static void operator delete(void* p, std::size_t size) noexcept {
+            detail::SlabAllocator::deallocate(p, size);
+        }
+
         virtual ~TaskInterface() { if (completion) completion->notify(); }
 
     }; // class TaskInterface
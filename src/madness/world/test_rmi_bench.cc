@@ -0,0 +1,122 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/// \file test_rmi_bench.cc
+/// \brief Latency and bandwidth of active messages between rank 0 and the last rank
+
+/// Run with at least two ranks; compare MAD_SHM_BUFFER_SIZE=0 (MPI only)
+/// with the default (shared memory between ranks on the same node).
+
+#include <madness/world/MADworld.h>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+using namespace madness;
+
+class Bench : public WorldObject<Bench> {
+    std::atomic<long> nrecv;
+public:
+    Bench(World& world) : WorldObject<Bench>(world), nrecv(0) {
+        process_pending();
+    }
+
+    /// Handler of the ping-pong ... the reply is the pong
+    long echo(const std::vector<char>& buf) {
+        return buf.size();
+    }
+
+    /// Handler of the one-way messages
+    void sink(const std::vector<char>& /*buf*/) {
+        nrecv++;
+    }
+
+    long received() const { return nrecv; }
+};
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc, argv);
+
+    const ProcessID other = world.size() - 1;
+    if (world.size() < 2) {
+        if (world.rank() == 0) print("test_rmi_bench needs at least two processes ... skipping");
+        finalize();
+        return 0;
+    }
+
+    Bench bench(world);
+    world.gop.fence();
+
+    const bool shm = RMI::is_node_local(other);
+    if (world.rank() == 0)
+        print("rank 0 <-> rank", other, " via", shm ? "shared memory" : "MPI", " with", RMI::nthread(), "server threads");
+
+    // Latency: half the round trip time of a ping-pong
+    for (std::size_t nbyte : {0, 64, 1024, 8192, 65536}) {
+        const int nrep = 1000;
+        std::vector<char> buf(nbyte, 'x');
+        double used = 0.0;
+        if (world.rank() == 0) {
+            for (int i=0; i<10; ++i) bench.send(other, &Bench::echo, buf).get();
+            used = wall_time();
+            for (int i=0; i<nrep; ++i) {
+                MADNESS_CHECK(bench.send(other, &Bench::echo, buf).get() == long(nbyte));
+            }
+            used = wall_time() - used;
+            printf("  latency %8zu bytes %10.2f us\n", nbyte, 0.5e6*used/nrep);
+        }
+        world.gop.fence();
+    }
+
+    // Bandwidth: a stream of one-way messages followed by a fence
+    long nsent = 0;
+    for (std::size_t nbyte : {1024, 8192, 65536, 262144}) {
+        const int nrep = std::max(64, int((16l << 20)/nbyte));
+        std::vector<char> buf(nbyte, 'x');
+        world.gop.fence();
+        double used = wall_time();
+        if (world.rank() == 0) {
+            for (int i=0; i<nrep; ++i) bench.send(other, &Bench::sink, buf);
+            nsent += nrep;
+        }
+        world.gop.fence();
+        used = wall_time() - used;
+        if (world.rank() == 0)
+            printf("bandwidth %8zu bytes %10.2f MB/s\n", nbyte, 1e-6*nbyte*nrep/used);
+    }
+
+    world.gop.broadcast(nsent, 0);
+    if (world.rank() == other) MADNESS_CHECK(bench.received() == nsent);
+    world.gop.fence();
+
+    finalize();
+    return 0;
+}
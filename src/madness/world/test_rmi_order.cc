@@ -0,0 +1,128 @@
+/*
+  This file is part of MADNESS.
+
+  Copyright (C) 2007,2010 Oak Ridge National Laboratory
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+
+  For more information please contact:
+
+  Robert J. Harrison
+  Oak Ridge National Laboratory
+  One Bethel Valley Road
+  P.O. Box 2008, MS-6367
+
+  email: harrisonrj@ornl.gov
+  tel:   865-241-3937
+  fax:   865-572-0680
+*/
+
+/// \file test_rmi_order.cc
+/// \brief Checks that ordered active messages arrive in order and intact
+
+/// Every rank sends a stream of ordered messages to every other rank.  The
+/// lengths are mixed so that consecutive messages go through the
+/// shared-memory rings, through MPI because they are too long for a ring,
+/// through MPI because a burst filled the ring, and as huge messages.  The
+/// receiver checks the sequence number and the contents of each message.
+/// Run with several ranks and with MAD_NUM_RMI_THREADS>1 to exercise the
+/// multiple server threads.
+
+#include <madness/world/MADworld.h>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+using namespace madness;
+
+class Order : public WorldObject<Order> {
+    std::vector<long> expected;  ///< Next sequence number from each source
+    std::atomic<long> nerror;
+public:
+    Order(World& world) : WorldObject<Order>(world), expected(world.size(),0), nerror(0) {
+        process_pending();
+    }
+
+    static unsigned char byte(ProcessID src, long seq, std::size_t j) {
+        return (unsigned char)(31*src + seq + j);
+    }
+
+    /// Handler of the ordered messages
+    void recv(ProcessID src, long seq, const std::vector<unsigned char>& buf) {
+        if (seq != expected[src]) {
+            print("out of order message from", src, ": got", seq, "expected", expected[src]);
+            nerror++;
+        }
+        expected[src] = seq + 1;
+        for (std::size_t j=0; j<buf.size(); ++j) {
+            if (buf[j] != byte(src, seq, j)) {
+                print("corrupt message from", src, "seq", seq, "at byte", j);
+                nerror++;
+                break;
+            }
+        }
+    }
+
+    long received(ProcessID src) const { return expected[src]; }
+    long errors() const { return nerror; }
+};
+
+/// Length of message seq ... mostly short, with some too long for a ring and a few huge ones
+static std::size_t length(long seq) {
+    if (seq%97 == 96) return 2*1024*1024;
+    if (seq%13 == 12) return 300000;
+    if (seq%5 == 4) return 65536;
+    return (seq*37)%2000;
+}
+
+int main(int argc, char** argv) {
+    World& world = initialize(argc, argv);
+    const ProcessID me = world.rank(), nproc = world.size();
+    const bool smalltest = (getenv("MAD_SMALL_TESTS") != nullptr);
+    const long nmsg = smalltest ? 200 : 1000;
+
+    Order order(world);
+    world.gop.fence();
+
+    // RMI is only started with more than one process
+    if (me == 0)
+        print("test_rmi_order:", nproc, "processes,", (nproc > 1) ? RMI::nthread() : 0,
+              "server threads,", nmsg, "messages per pair");
+
+    // Interleave the destinations so that all pairs are active at once
+    for (long seq=0; seq<nmsg; ++seq) {
+        std::vector<unsigned char> buf(length(seq));
+        for (ProcessID k=1; k<=nproc; ++k) {
+            const ProcessID dest = (me + k) % nproc;
+            for (std::size_t j=0; j<buf.size(); ++j) buf[j] = Order::byte(me, seq, j);
+            order.send(dest, &Order::recv, me, seq, buf);
+        }
+    }
+    world.gop.fence();
+
+    long nerror = order.errors();
+    for (ProcessID src=0; src<nproc; ++src) {
+        if (order.received(src) != nmsg) {
+            print(me, ": received", order.received(src), "messages from", src, "expected", nmsg);
+            nerror++;
+        }
+    }
+    world.gop.sum(nerror);
+    if (me == 0) print(nerror ? "test_rmi_order: FAILED" : "test_rmi_order: OK");
+    world.gop.fence();
+
+    finalize();
+    return nerror ? 1 : 0;
+}
@@ -1175,6 +1175,101 @@ void test13(World& world) {
     world.gop.fence();
 }
 
+class FencePing : public WorldObject<FencePing> {
+public:
+    FencePing(World& world) : WorldObject<FencePing>(world) {
+        process_pending();
+    }
+
+    void ping() {}
+};
+
+// fence count and latency, with and without AM since the previous fence
+void test_fence(World& world) {
+    FencePing p(world);
+    world.gop.fence();
+
+    const int nfence = 100;
+    for (int communicate=0; communicate<2; ++communicate) {
+        const auto stats0 = world.gop.get_fence_statistics();
+        const double start = wall_time();
+        for (int i=0; i<nfence; ++i) {
+            if (communicate) p.send((world.rank()+1)%world.size(), &FencePing::ping);
+            world.gop.fence();
+        }
+        const double used = wall_time()-start;
+        const auto stats1 = world.gop.get_fence_statistics();
+        MADNESS_CHECK(stats1.nfence-stats0.nfence == std::size_t(nfence));
+
+        const double nwave = double(stats1.nwave-stats0.nwave)/nfence;
+        if (communicate and (world.size() > 1)) MADNESS_CHECK(nwave >= 2.0);
+        else MADNESS_CHECK(nwave == 1.0);
+        print("fence", (communicate ? "after AM:      " : "without AM:    "),
+              used/nfence*1e6, "microseconds per fence,", nwave, "waves per fence");
+    }
+    print("test_fence OK");
+}
+
+static int task_creation_increment(int i) { return i+1; }
+
+// creation rate of tasks, futures and AM arguments, which come from the slab allocator
+void test_task_creation(World& world) {
+    const int n = 100000;
+    const int nbatch = 1000;
+    const std::size_t size = 200;  // a typical task
+
+    // raw allocation in batches, as a task queue would do
+    std::vector<void*> p(nbatch);
+    double start = wall_time();
+    for (int i=0; i<n; i+=nbatch) {
+        for (int j=0; j<nbatch; ++j) p[j] = ::operator new(size);
+        for (int j=0; j<nbatch; ++j) ::operator delete(p[j]);
+    }
+    const double used_new = wall_time()-start;
+    start = wall_time();
+    for (int i=0; i<n; i+=nbatch) {
+        for (int j=0; j<nbatch; ++j) p[j] = detail::SlabAllocator::allocate(size);
+        for (int j=0; j<nbatch; ++j) detail::SlabAllocator::deallocate(p[j], size);
+    }
+    const double used_slab = wall_time()-start;
+    print("allocation:     new/delete", used_new/n*1e9, "ns, slab", used_slab/n*1e9, "ns");
+
+    // unassigned futures with their implementation object
+    start = wall_time();
+    long sum = 0;
+    for (int i=0; i<n; i+=nbatch) {
+        std::vector< Future<int> > f(nbatch);
+        for (int j=0; j<nbatch; ++j) f[j].set(j);
+        for (int j=0; j<nbatch; ++j) sum += f[j].get();
+    }
+    double used = wall_time()-start;
+    MADNESS_CHECK(sum == long(n/nbatch)*(nbatch*(nbatch-1)/2));
+    print("futures:       ", used/n*1e9, "ns per future");
+
+    // AM arguments
+    start = wall_time();
+    for (int i=0; i<n; ++i) {
+        AmArg* arg = new_am_arg(i, 1.0*i);
+        free_am_arg(arg);
+    }
+    used = wall_time()-start;
+    print("AM arguments:  ", used/n*1e9, "ns per argument");
+
+    // tasks, including their result futures
+    world.gop.fence();
+    start = wall_time();
+    std::vector< Future<int> > r(n);
+    for (int i=0; i<n; ++i) r[i] = world.taskq.add(task_creation_increment, i);
+    world.gop.fence();
+    used = wall_time()-start;
+    for (int i=0; i<n; ++i) MADNESS_CHECK(r[i].get() == i+1);
+    print("tasks:         ", used/n*1e9, "ns per task");
+
+    const auto stats = detail::SlabAllocator::get_statistics();
+    print("slab allocator:", stats.nslab, "slabs,", stats.nbyte, "bytes");
+    print("test_task_creation OK");
+}
+
 void test14(World& world) {
 
   if (world.size() > 1) {
@@ -1388,6 +1483,8 @@ int main(int argc, char** argv) {
         test13(world);
         test14(world);
         test15(world);
+        test_fence(world);
+        test_task_creation(world);
 
         for (int i=0; i<10; ++i) {
           print("REPETITION",i);
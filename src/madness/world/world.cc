@@ -289,10 +289,12 @@ namespace madness {
         double nbyte_sent = rmi.nbyte_sent;
         double nbyte_recv = rmi.nbyte_recv;
         double server_q = rmi.max_serv_send_q;
+        double nmsg_sent_shm = rmi.nmsg_sent_shm;
         world.gop.sum(nmsg_sent);
         world.gop.sum(nmsg_recv);
         world.gop.sum(nbyte_sent);
         world.gop.sum(nbyte_recv);
+        world.gop.sum(nmsg_sent_shm);
         world.gop.sum(server_q);
 
         double max_nmsg_sent = rmi.nmsg_sent;
@@ -389,6 +391,7 @@ namespace madness {
                    min_nbyte_recv, nbyte_recv/world.size(), max_nbyte_recv);
             printf("        #msgs systemwide    %.2e\n", nmsg_sent);
             printf("       #bytes systemwide    %.2e\n", nbyte_sent);
+            printf(" #msgs via shared memory    %.2e\n", nmsg_sent_shm);
             printf("\n");
             printf("  Thread pool statistics (min / avg / max)\n");
             printf("  ----------------------\n");
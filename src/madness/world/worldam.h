@@ -38,7 +38,9 @@
 #include <madness/world/buffer_archive.h>
 #include <madness/world/worldrmi.h>
 #include <madness/world/world.h>
+#include <madness/world/slab_allocator.h>
 #include <vector>
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <pthread.h>
@@ -84,15 +86,23 @@ namespace madness {
 
         friend AmArg* alloc_am_arg(std::size_t nbyte);
 
+        friend AmArg* copy_am_arg(const AmArg& arg);
+        friend void free_am_arg(AmArg* arg);
+        template <typename... argT> friend AmArg* new_am_arg(const argT&... args);
+
+        static constexpr std::size_t nbyte_fields = sizeof(std::size_t) + sizeof(std::uint64_t)
+            + sizeof(std::ptrdiff_t) + sizeof(ProcessID) + sizeof(unsigned int) + sizeof(void*);
+
         unsigned char header[RMI::HEADER_LEN]; // !!!!!!!!!  MUST BE FIRST !!!!!!!!!!
-        std::size_t nbyte;      // Size of user payload
+        std::size_t nbyte;      // Size of user payload, including gathered segments
         std::uint64_t worldid;  // Id of associated world
         std::ptrdiff_t func;    // User function to call, as a relative fn ptr (see archive::to_rel_fn_ptr)
         ProcessID src;          // Rank of process sending the message
         unsigned int flags;     // Misc. bit flags
+        archive::BufferSegmentList* segments; // Payload sent from where it lives (sender only, else null)
+        unsigned char pad[RMI::ALIGNMENT - nbyte_fields%RMI::ALIGNMENT]; // Payload starts aligned in recv buffers
 
-        // On 32 bit machine AmArg is HEADER_LEN+4+4+4+4+4=84 bytes
-        // On 64 bit machine AmArg is HEADER_LEN+8+8+8+4+4=96 bytes
+        // On 64 bit machine AmArg is HEADER_LEN+8+8+8+4+4+8+24=128 bytes
 
         // No copy constructor or assignment
         AmArg(const AmArg&);
@@ -118,13 +128,26 @@ namespace madness {
         am_handlerT get_func() const { return archive::to_abs_fn_ptr<am_handlerT>(func); }
 
         archive::BufferInputArchive make_input_arch() const {
+            // Large tensors of a huge message may stay in its buffer
+            const std::shared_ptr<void>& owner = RMI::get_recv_buffer_owner();
+            if (owner.get() == this) return archive::BufferInputArchive(buf(),size(),owner);
             return archive::BufferInputArchive(buf(),size());
         }
 
         archive::BufferOutputArchive make_output_arch() const {
+            if (segments) return archive::BufferOutputArchive(buf(),inline_size(),segments);
             return archive::BufferOutputArchive(buf(),size());
         }
 
+        /// Size of the payload in this buffer, i.e., excluding gathered segments
+        std::size_t inline_size() const {
+            std::size_t n = size();
+            if (segments) {
+                for (const auto& s : *segments) n -= s.nbyte;
+            }
+            return n;
+        }
+
     public:
         AmArg() {}
 
@@ -157,26 +180,35 @@ namespace madness {
         std::uint64_t get_worldid() const { return worldid; }
     };
 
+    static_assert(sizeof(AmArg) % RMI::ALIGNMENT == 0, "AmArg must keep the payload aligned");
+
 
     /// Allocates a new AmArg with nbytes of user data ... delete with free_am_arg
+
+    /// Small messages come from the slab allocator of the calling thread.
     inline AmArg* alloc_am_arg(std::size_t nbyte) {
         std::size_t narg = 1 + (nbyte+sizeof(AmArg)-1)/sizeof(AmArg);
-        AmArg *arg = new AmArg[narg];
+        AmArg *arg = new (detail::SlabAllocator::allocate(narg*sizeof(AmArg))) AmArg;
         arg->set_size(nbyte);
+        arg->segments = nullptr;
         return arg;
     }
 
 
     inline AmArg* copy_am_arg(const AmArg& arg) {
-        AmArg* r = alloc_am_arg(arg.size());
-        memcpy(reinterpret_cast<void*>(r), &arg, arg.size()+sizeof(AmArg));
+        const std::size_t ninline = arg.inline_size();
+        AmArg* r = alloc_am_arg(ninline);
+        memcpy(reinterpret_cast<void*>(r), &arg, ninline+sizeof(AmArg));
+        if (arg.segments) r->segments = new archive::BufferSegmentList(*arg.segments);
         return r;
     }
 
     /// Frees an AmArg allocated with alloc_am_arg
     inline void free_am_arg(AmArg* arg) {
         //std::cout << " freeing amarg " << (void*)(arg) << " " << pthread_self() << std::endl;
-        delete [] arg;
+        std::size_t narg = 1 + (arg->inline_size()+sizeof(AmArg)-1)/sizeof(AmArg);
+        delete arg->segments;
+        detail::SlabAllocator::deallocate(arg, narg*sizeof(AmArg));
     }
 
     /// Terminate argument serialization
@@ -190,14 +222,22 @@ namespace madness {
     }
 
     /// Convenience template for serializing arguments into a new AmArg
+
+    /// Large tensors are not copied into the message but gathered from
+    /// where they live when the message is sent.
     template <typename... argT>
     inline AmArg* new_am_arg(const argT&... args) {
         // compute size
-        archive::BufferOutputArchive count;
+        archive::BufferSegmentList segments;
+        archive::BufferOutputArchive count(nullptr, 0, &segments);
         serialize_am_args(count, args...);
 
         // Serialize arguments
-        AmArg* am_args = alloc_am_arg(count.size());
+        AmArg* am_args = alloc_am_arg(count.size() - count.size_gathered());
+        if (count.size_gathered()) {
+            am_args->set_size(count.size());
+            am_args->segments = new archive::BufferSegmentList();
+        }
         serialize_am_args(*am_args, args...);
         return am_args;
     }
@@ -215,6 +255,26 @@ namespace madness {
         static const int DEFAULT_NSEND = 128;
 #endif
 
+        /// Sends the message in \c arg and its gathered segments
+        static RMI::Request isend(const AmArg* arg, ProcessID dest, const int attr) {
+            if (!arg->segments) return RMI::isend(arg, arg->size()+sizeof(AmArg), dest, handler, attr);
+
+            const archive::BufferSegmentList& segments = *(arg->segments);
+            std::vector<RMIBlock> blocks;
+            blocks.reserve(2*segments.size() + 1);
+            std::size_t offset = 0, ninline = 0; // position in the payload and in the buffer
+            for (const auto& s : segments) {
+                blocks.push_back({arg->buf() + ninline, s.offset - offset});
+                blocks.push_back({s.ptr, s.nbyte});
+                ninline += s.offset - offset;
+                offset = s.offset + s.nbyte;
+            }
+            blocks.push_back({arg->buf() + ninline, arg->size() - offset});
+            blocks.front().ptr = arg;
+            blocks.front().nbyte += sizeof(AmArg);
+            return RMI::isend(blocks.data(), int(blocks.size()), dest, handler, attr);
+        }
+
         class SendReq : public SPINLOCK_TYPE, public RMISendReq {
             AmArg* buf;
             RMI::Request req;
@@ -244,19 +304,25 @@ namespace madness {
         unsigned long worldid;              ///< The world which contains this instance of WorldAmInterface
         const ProcessID rank;
         const int nproc;
-        // Next 3 were volatile but no need since protected by spinlock with implied barriers/fence
+        // cur_msg is protected by the spinlock.  nsent and nrecv are atomic
+        // since nrecv is updated by every RMI server thread (and by pool
+        // tasks handling large unordered messages) without the lock.
         int cur_msg;               ///< Index of next buffer to attempt to use
-        unsigned long nsent;       ///< Counts no. of AM sent for purpose of termination detection
-        unsigned long nrecv;       ///< Counts no. of AM received for purpose of termination detection
+        std::atomic<unsigned long> nsent; ///< Counts no. of AM sent for purpose of termination detection
+        std::atomic<unsigned long> nrecv; ///< Counts no. of AM received for purpose of termination detection
 
         std::vector<int> map_to_comm_world; ///< Maps rank in current MPI communicator to SafeMPI::COMM_WORLD
 
         /// This handles all incoming RMI messages for all instances
         static void handler(void *buf, std::size_t nbyte) {
-            // It will be singled threaded since only the RMI receiver
-            // thread will invoke it ... however note that nrecv will
-            // be read by the main thread during fence operations.
+            // With MAD_NUM_RMI_THREADS>1 several server threads run this
+            // concurrently, and unordered messages above the handoff size
+            // are run from the thread pool, so this must be thread safe.
+            // Messages from one source are still handled in order by a
+            // single server.  nrecv is atomic and is read by the main
+            // thread during fence operations.
             AmArg* arg = static_cast<AmArg*>(buf);
+            arg->segments = nullptr; // Segments arrived in place
             am_handlerT func = arg->get_func();
             World* w = arg->get_world();
             MADNESS_ASSERT(arg->size() + sizeof(AmArg) == nbyte);
@@ -308,9 +374,9 @@ namespace madness {
                 // processes in its main loop using the RMI::send
                 // interface.
 
-                lock(); nsent++; unlock(); // This world must still keep track of messages
+                nsent++; // This world must still keep track of messages
 
-                RMI::send_req.emplace_back(std::make_unique<SendReq>((AmArg*)(arg), RMI::isend(arg, arg->size()+sizeof(AmArg), dest, handler, attr)));
+                RMI::send_req.emplace_back(std::make_unique<SendReq>((AmArg*)(arg), isend(arg, dest, attr)));
 
                 //std::cout << "sending message from server " << (void*)(arg) << " " << pthread_self() << " " << p <<  std::endl;
 
@@ -346,7 +412,7 @@ namespace madness {
             }
 
             // Buffer is now free but still locked by me
-            send_req[i].set((AmArg*)(arg), RMI::isend(arg, arg->size()+sizeof(AmArg), dest, handler, attr));
+            send_req[i].set((AmArg*)(arg), isend(arg, dest, attr));
             send_req[i].unlock(); // << matches try_lock above
         }
 
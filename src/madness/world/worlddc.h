@@ -520,7 +520,7 @@ namespace madness {
                 acc->second = datum.second;
             }
             else {
-  	        // Must be send (not task) for sequential consistency (and relies on single-threaded remote server)
+  	        // Must be send (not task) for sequential consistency (and relies on all messages from one source being handled in order by one remote server thread)
                 this->send(dest, &implT::insert, datum);
             }
         }
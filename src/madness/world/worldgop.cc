@@ -40,44 +40,33 @@ namespace madness {
 
     /// Synchronizes all processes in communicator AND globally ensures no pending AM or tasks
 
-    /// Runs Dykstra-like termination algorithm on binary tree by
+    /// Runs a wave-based termination algorithm by
     /// locally ensuring ntask=0 and all am sent and processed,
     /// and then participating in a global sum of nsent and nrecv.
     /// Then globally checks that nsent=nrecv and that both are
-    /// constant over two traversals.  We are then we are sure
+    /// constant over two waves.  We are then we are sure
     /// that all tasks and AM are processed and there no AM in
     /// flight.
+    ///
+    /// Each wave is a non-blocking allreduce; while it is in flight
+    /// this process keeps executing tasks and AM, which are then
+    /// accounted for by the next wave.  Since the counters only grow,
+    /// the last wave of the previous fence is a valid previous wave,
+    /// and a fence without AM since the previous fence needs a single wave.
     void WorldGopInterface::fence_impl(std::function<void()> epilogue,
                                    bool pause_during_epilogue,
                                    bool debug) {
         PROFILE_MEMBER_FUNC(WorldGopInterface);
         MADNESS_CHECK(not forbid_fence_);
-        unsigned long nsent_prev=0, nrecv_prev=1; // invalid initial condition
-        SafeMPI::Request req0, req1;
-        ProcessID parent, child0, child1;
-        world_.mpi.binary_tree_info(0, parent, child0, child1);
-        Tag gfence_tag = world_.mpi.unique_tag();
-        Tag bcast_tag = world_.mpi.unique_tag();
+        const double start = wall_time();
         int npass = 0;
 
-        //double start = wall_time();
-
       if (debug)
-        madness::print(world_.rank(), ": WORLD.GOP.FENCE: entering fence loop, gfence_tag=", gfence_tag, " bcast_tag=", bcast_tag);
+        madness::print(world_.rank(), ": WORLD.GOP.FENCE: entering fence loop, nsent_prev=", fence_nsent_, " nrecv_prev=", fence_nrecv_);
 
       while (1) {
-            uint64_t sum0[2]={0,0}, sum1[2]={0,0}, sum[2];
-            if (child0 != -1) req0 = world_.mpi.Irecv((void*) &sum0, sizeof(sum0), MPI_BYTE, child0, gfence_tag);
-            if (child1 != -1) req1 = world_.mpi.Irecv((void*) &sum1, sizeof(sum1), MPI_BYTE, child1, gfence_tag);
-            world_.taskq.fence();
-            if (child0 != -1) World::await(req0);
-            if (child1 != -1) World::await(req1);
-
-            if (debug && (child0 != -1 || child1 != -1))
-              madness::print(world_.rank(), ": WORLD.GOP.FENCE: npass=", npass, " received messages from children={", child0, ",", child1, "} gfence_tag=", gfence_tag);
-
             bool finished;
-            uint64_t ntask1, nsent1, nrecv1, ntask2, nsent2, nrecv2;
+            unsigned long ntask1, nsent1, nrecv1, ntask2, nsent2, nrecv2;
             do {
                 world_.taskq.fence();
 
@@ -102,48 +91,26 @@ namespace madness {
             }
             while (!finished);
 
-            sum[0] = sum0[0] + sum1[0] + nsent2; // Must use values read above
-            sum[1] = sum0[1] + sum1[1] + nrecv2;
+            unsigned long local[2] = {nsent2, nrecv2}; // Must use values read above
+            unsigned long sum[2] = {nsent2, nrecv2};
 
-            if (parent != -1) {
-                req0 = world_.mpi.Isend(&sum, sizeof(sum), MPI_BYTE, parent, gfence_tag);
-                if (debug)
-                  madness::print(world_.rank(), ": WORLD.GOP.FENCE: npass=", npass, " sent message to parent=", parent, " gfence_tag=", gfence_tag);
-                World::await(req0);
-                if (debug)
-                  madness::print(world_.rank(), ": WORLD.GOP.FENCE: npass=", npass, " parent=", parent, ", confirmed receipt");
+            if (world_.size() > 1) {
+                SafeMPI::Request req = world_.mpi.comm().Iallreduce(local, sum, 2, MPI_UNSIGNED_LONG, MPI_SUM);
+                World::await(req, true);
             }
-
-            // While we are probably idle free unused communication buffers
-            //world_.am.free_managed_buffers();
-
-            //bool dowork = (npass==0) || (ThreadPool::size()==0);
-            bool dowork = true;
-            broadcast(&sum, sizeof(sum), 0, dowork, bcast_tag);
             ++npass;
 
             if (debug)
-              madness::print(world_.rank(), ": WORLD.GOP.FENCE: npass=", npass, " sum0=", sum[0], " nsent_prev=", nsent_prev, " sum1=", sum[1], " nrecv_prev=", nrecv_prev);
+              madness::print(world_.rank(), ": WORLD.GOP.FENCE: npass=", npass, " sum0=", sum[0], " nsent_prev=", fence_nsent_, " sum1=", sum[1], " nrecv_prev=", fence_nrecv_);
 
-            if (sum[0]==sum[1] && sum[0]==nsent_prev && sum[1]==nrecv_prev) {
+            const bool done = (sum[0]==sum[1] && sum[0]==fence_nsent_ && sum[1]==fence_nrecv_);
+            fence_nsent_ = sum[0];
+            fence_nrecv_ = sum[1];
+            if (done) {
               if (debug)
                 madness::print(world_.rank(), ": WORLD.GOP.FENCE: npass=", npass, " exiting fence loop");
               break;
             }
-
-//                 if (wall_time() - start > 1200.0) {
-//                     std::cout << rank() << " FENCE " << nsent2 << " "
-//                         << nsent_prev << " " << nrecv2 << " " << nrecv_prev
-//                         << " " << sum[0] << " " << sum[1] << " " << npass
-//                         << " " << taskq.size() << std::endl;
-//                     std::cout.flush();
-//                     //myusleep(1000);
-//                     MADNESS_ASSERT(0);
-//                 }
-
-            nsent_prev = sum[0];
-            nrecv_prev = sum[1];
-
         };
         // execute post-fence actions
         MADNESS_ASSERT(pause_during_epilogue == false);
@@ -154,6 +121,9 @@ namespace madness {
         MallocExtension::instance()->ReleaseFreeMemory();
 //        print("clearing memory");
 #endif
+        ++nfence_;
+        nwave_ += npass;
+        fence_time_ += wall_time() - start;
       if (debug)
         madness::print(world_.rank(), ": WORLD.GOP.FENCE: done with fence in ", npass, (npass > 1 ? " loops" : " loop"));
     }
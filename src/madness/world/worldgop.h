@@ -147,6 +147,11 @@ namespace madness {
         std::shared_ptr<detail::DeferredCleanup> deferred_; ///< Deferred cleanup object.
         bool debug_; ///< Debug mode
         bool forbid_fence_=false; ///< forbid calling fence() in case of several active worlds
+        unsigned long fence_nsent_=0; ///< global number of AM sent at the end of the last fence
+        unsigned long fence_nrecv_=1; ///< global number of AM received at the end of the last fence (invalid initially)
+        std::size_t nfence_=0; ///< number of fences
+        std::size_t nwave_=0; ///< number of termination-detection waves in all fences
+        double fence_time_=0.0; ///< wall time spent in fences
 
         friend class detail::DeferredCleanup;
 
@@ -660,16 +665,31 @@ namespace madness {
 
         /// Synchronizes all processes in communicator AND globally ensures no pending AM or tasks
 
-        /// \internal Runs Dykstra-like termination algorithm on binary tree by
+        /// \internal Runs a wave-based termination algorithm by
         /// locally ensuring ntask=0 and all am sent and processed,
-        /// and then participating in a global sum of nsent and nrecv.
+        /// and then participating in a non-blocking global sum of nsent
+        /// and nrecv, while tasks and AM continue to be processed.
         /// Then globally checks that nsent=nrecv and that both are
-        /// constant over two traversals.  We are then sure
+        /// constant over two waves.  We are then sure
         /// that all tasks and AM are processed and there no AM in
-        /// flight.
+        /// flight.  The last wave of the previous fence counts as a
+        /// wave, so a fence without AM since the previous one
+        /// completes after a single wave.
         /// \param[in] debug set to true to print progress statistics using madness::print(); the default is false.
         void fence(bool debug = false);
 
+        /// Statistics of the fences in this world
+        struct FenceStatistics {
+            std::size_t nfence; ///< number of fences
+            std::size_t nwave;  ///< number of termination-detection waves in all fences
+            double time;        ///< wall time spent in fences
+        };
+
+        /// Returns the number of fences, termination-detection waves and the time spent in fences
+        FenceStatistics get_fence_statistics() const {
+            return FenceStatistics{nfence_, nwave_, fence_time_};
+        }
+
         /// Executes an action on single (this) thread after ensuring all other work is done
 
         /// \param[in] action the action to execute (by the calling thread)
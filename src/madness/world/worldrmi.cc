@@ -41,21 +41,290 @@
 #include <list>
 #include <memory>
 #include <atomic>
+#include <vector>
+#include <cstring>
+#include <cstdint>
 #include <madness/world/safempi.h>
 #include <madness/world/archive.h>
 
 namespace madness {
 
-    std::unique_ptr<RMI::RmiTask> RMI::task_ptr = nullptr;
-    RMIStats RMI::stats;
+    std::vector< std::unique_ptr<RMI::RmiTask> > RMI::tasks;
+    RMI::RmiTask* RMI::task_ptr = nullptr;
     bool RMI::debugging = false;
-    std::list< std::unique_ptr<RMISendReq> > RMI::send_req;
+    thread_local std::list< std::unique_ptr<RMISendReq> > RMI::send_req;
 
     bool& RMI::is_server_thread_accessor() {
       static thread_local bool is_server_thread = false;
       return is_server_thread;
     }
 
+    RMI::RmiTask*& RMI::RmiTask::this_task_accessor() {
+      static thread_local RmiTask* this_task = nullptr;
+      return this_task;
+    }
+
+    std::shared_ptr<void>& RMI::RmiTask::recv_buf_owner_accessor() {
+      static thread_local std::shared_ptr<void> owner;
+      return owner;
+    }
+
+    /// Copy a message into a buffer of its own, aligned like the recv buffers
+    static std::shared_ptr<void> copy_message(const void* buf, std::size_t nbyte) {
+        void* copy = nullptr;
+        if (posix_memalign(&copy, RMI::ALIGNMENT, nbyte))
+            MADNESS_EXCEPTION("RMI: failed allocating a copy of a message", 1);
+        std::memcpy(copy, buf, nbyte);
+        return std::shared_ptr<void>(copy, &free);
+    }
+
+    /// Runs the handler of a message in the thread pool, keeping its buffer alive
+    class RMI::RmiTask::HandlerTask : public PoolTaskInterface {
+        rmi_handlerT func;
+        std::shared_ptr<void> owner;
+        std::size_t nbyte;
+
+    public:
+        HandlerTask(rmi_handlerT func, const std::shared_ptr<void>& owner, std::size_t nbyte)
+            : func(func), owner(owner), nbyte(nbyte) {}
+
+        void run(const TaskThreadEnv& /*info*/) {
+            std::shared_ptr<void>& current = recv_buf_owner_accessor();
+            current = owner;
+            func(owner.get(), nbyte);
+            current.reset();
+        }
+
+        virtual ~HandlerTask() {}
+
+    private:
+        virtual void get_id(std::pair<void*,unsigned short>& id) const {
+            PoolTaskInterface::make_id(id, &HandlerTask::run);
+        }
+    };
+
+#ifndef STUBOUTMPI
+    /// Lock-free shared-memory rings between the ranks of a node
+
+    /// Each rank owns, in an MPI-3 shared memory window, one ring for every
+    /// rank of its node (itself included), into which that rank writes the
+    /// messages addressed to the owner. A message occupies a record made of
+    /// one ALIGNMENT-long word holding its length, followed by the message
+    /// padded to ALIGNMENT bytes, so that handlers see the same alignment as
+    /// in the recv buffers. A record that does not fit before the end of the
+    /// ring is preceded by a wrap marker and starts at the beginning.
+    /// The segment of each rank starts with one flag per server thread, set
+    /// while that thread is blocked in MPI, in which case a sender wakes it
+    /// up with an MPI message. Construction and destruction are collective
+    /// over the node.
+    class RMI::RmiTask::ShmTransport {
+        struct alignas(ALIGNMENT) counter {
+            std::atomic<std::uint64_t> value;
+        };
+
+        struct ring {
+            counter* head;          // Written by the producer only
+            counter* tail;          // Written by the consumer only
+            unsigned char* data;
+        };
+
+        static constexpr std::uint64_t WRAP = ~std::uint64_t(0);
+
+        static std::size_t padded(std::size_t nbyte) {
+            return (nbyte + ALIGNMENT - 1)/ALIGNMENT*ALIGNMENT;
+        }
+
+        SafeMPI::Intracomm nodecomm;
+        MPI_Win win;
+        std::size_t capacity;           // Bytes of data in each ring
+        std::size_t max_msg_len_;       // Longer messages are sent with MPI
+        std::vector<int> node_ranks;    // Node rank of each rank in comm, or -1
+        std::vector<ProcessID> comm_ranks; // Rank in comm of each node rank
+        std::vector<ring> in;           // Rings from each node rank to me
+        std::vector<ring> out;          // Rings from me to each node rank
+        int nthread;                    // No. of server threads of each rank
+        counter* sleeping;              // My flags
+        std::vector<counter*> out_sleeping; // Flags of each node rank
+
+        ring make_ring(unsigned char* segment, int i) const {
+            unsigned char* p = segment + nthread*ALIGNMENT + i*(2*ALIGNMENT + capacity);
+            return ring{reinterpret_cast<counter*>(p),
+                        reinterpret_cast<counter*>(p + ALIGNMENT),
+                        p + 2*ALIGNMENT};
+        }
+
+    public:
+        ShmTransport(const SafeMPI::Intracomm& comm, const SafeMPI::Intracomm& nodecomm,
+                     std::size_t ring_len, std::size_t max_msg_len, int nthread)
+            : nodecomm(nodecomm)
+            , capacity(padded(ring_len))
+            , max_msg_len_(std::min(capacity/4, max_msg_len))
+            , node_ranks(comm.Get_size())
+            , comm_ranks(nodecomm.Get_size())
+            , in(nodecomm.Get_size())
+            , out(nodecomm.Get_size())
+            , nthread(nthread)
+            , sleeping(nullptr)
+            , out_sleeping(nodecomm.Get_size())
+        {
+            const int nnode = nodecomm.Get_size();
+            const int me = nodecomm.Get_rank();
+
+            // Map between the ranks in comm and on the node
+            std::vector<int> ranks(comm.Get_size());
+            for (int p=0; p<comm.Get_size(); ++p) ranks[p] = p;
+            comm.Get_group().Translate_ranks(comm.Get_size(), ranks.data(),
+                                             nodecomm.Get_group(), node_ranks.data());
+            for (int p=0; p<comm.Get_size(); ++p) {
+                if (node_ranks[p] == MPI_UNDEFINED) node_ranks[p] = -1;
+                else comm_ranks[node_ranks[p]] = p;
+            }
+
+            // Allocate and initialize my incoming rings
+            unsigned char* mine = nullptr;
+            {
+                SAFE_MPI_GLOBAL_MUTEX;
+                void* ptr = nullptr;
+                MADNESS_MPI_TEST(MPI_Win_allocate_shared(nthread*ALIGNMENT + nnode*(2*ALIGNMENT + capacity), ALIGNMENT,
+                                                         MPI_INFO_NULL, nodecomm.Get_mpi_comm(), &ptr, &win));
+                mine = static_cast<unsigned char*>(ptr);
+                sleeping = reinterpret_cast<counter*>(mine);
+                for (int t=0; t<nthread; ++t) new (sleeping + t) counter{{0}};
+                for (int s=0; s<nnode; ++s) {
+                    in[s] = make_ring(mine, s);
+                    new (in[s].head) counter{{0}};
+                    new (in[s].tail) counter{{0}};
+                }
+                MADNESS_MPI_TEST(MPI_Win_lock_all(MPI_MODE_NOCHECK, win));
+                MADNESS_MPI_TEST(MPI_Win_sync(win));
+            }
+            nodecomm.Barrier();
+
+            // Find my outgoing rings in the segments of the others
+            SAFE_MPI_GLOBAL_MUTEX;
+            MADNESS_MPI_TEST(MPI_Win_sync(win));
+            for (int d=0; d<nnode; ++d) {
+                MPI_Aint size;
+                int disp_unit;
+                void* ptr = nullptr;
+                MADNESS_MPI_TEST(MPI_Win_shared_query(win, d, &size, &disp_unit, &ptr));
+                MADNESS_ASSERT(reinterpret_cast<std::uintptr_t>(ptr) % ALIGNMENT == 0);
+                out[d] = make_ring(static_cast<unsigned char*>(ptr), me);
+                out_sleeping[d] = static_cast<counter*>(ptr);
+            }
+        }
+
+        ShmTransport(const ShmTransport& other) = delete;
+        ShmTransport& operator=(const ShmTransport& other) = delete;
+
+        ~ShmTransport() {
+            int finalized;
+            MPI_Finalized(&finalized);
+            if (finalized) return;
+            SAFE_MPI_GLOBAL_MUTEX;
+            MPI_Win_unlock_all(win);
+            MPI_Win_free(&win);
+        }
+
+        /// Number of ranks on the node
+        int size() const { return in.size(); }
+
+        /// Rank on the node of rank @p p in comm, or -1 if it is on another node
+        int node_rank(ProcessID p) const { return node_ranks[p]; }
+
+        /// Rank in comm of rank @p s on the node
+        ProcessID comm_rank(int s) const { return comm_ranks[s]; }
+
+        /// Longest message that goes through the rings
+        std::size_t max_msg_len() const { return max_msg_len_; }
+
+        /// Copy a message into the ring to node rank @p d, unless the ring is full
+
+        /// Must not be called concurrently for the same ring
+        /// @return false if the ring has no room for the message
+        bool push(int d, const RMIBlock* blocks, int nblock, std::size_t nbyte) {
+            ring& r = out[d];
+            std::uint64_t head = r.head->value.load(std::memory_order_relaxed);
+            const std::uint64_t tail = r.tail->value.load(std::memory_order_acquire);
+            const std::size_t reclen = ALIGNMENT + padded(nbyte);
+            std::size_t offset = head % capacity;
+            const std::size_t skip = (offset + reclen > capacity) ? capacity - offset : 0;
+            if (head + skip + reclen - tail > capacity) return false;
+
+            if (skip) {
+                *reinterpret_cast<std::uint64_t*>(r.data + offset) = WRAP;
+                head += skip;
+                offset = 0;
+            }
+            unsigned char* p = r.data + offset + ALIGNMENT;
+            for (int b=0; b<nblock; ++b) {
+                std::memcpy(p, blocks[b].ptr, blocks[b].nbyte);
+                p += blocks[b].nbyte;
+            }
+            *reinterpret_cast<std::uint64_t*>(r.data + offset) = nbyte;
+            r.head->value.store(head + reclen, std::memory_order_release);
+            return true;
+        }
+
+        /// The oldest message in the ring from node rank @p s
+
+        /// @param[out] nbyte Length of the message
+        /// @return The message, or null if the ring is empty
+        void* front(int s, std::size_t& nbyte) {
+            ring& r = in[s];
+            std::uint64_t tail = r.tail->value.load(std::memory_order_relaxed);
+            while (tail != r.head->value.load(std::memory_order_acquire)) {
+                const std::size_t offset = tail % capacity;
+                const std::uint64_t len = *reinterpret_cast<const std::uint64_t*>(r.data + offset);
+                if (len != WRAP) {
+                    nbyte = len;
+                    return r.data + offset + ALIGNMENT;
+                }
+                tail += capacity - offset;
+                r.tail->value.store(tail, std::memory_order_release);
+            }
+            return nullptr;
+        }
+
+        /// Announce whether server thread @p t is about to block in MPI
+
+        /// After announcing sleep the thread must look at its rings once
+        /// more before blocking, since a sender may have missed the flag
+        void set_sleeping(int t, bool flag) {
+            sleeping[t].value.store(flag, std::memory_order_seq_cst);
+        }
+
+        /// After pushing a message, test if server thread @p t of node rank @p d must be woken up
+
+        /// @return true (to one caller only) if the thread announced sleep
+        bool wake_needed(int d, int t) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::atomic<std::uint64_t>& flag = out_sleeping[d][t].value;
+            return flag.load(std::memory_order_relaxed) && flag.exchange(0);
+        }
+
+        /// Release the oldest message, of length @p nbyte, in the ring from node rank @p s
+        void pop(int s, std::size_t nbyte) {
+            ring& r = in[s];
+            const std::uint64_t tail = r.tail->value.load(std::memory_order_relaxed);
+            r.tail->value.store(tail + ALIGNMENT + padded(nbyte), std::memory_order_release);
+        }
+    };
+#else
+    class RMI::RmiTask::ShmTransport {
+    public:
+        int size() const { return 0; }
+        int node_rank(ProcessID) const { return -1; }
+        ProcessID comm_rank(int) const { return -1; }
+        std::size_t max_msg_len() const { return 0; }
+        bool push(int, const RMIBlock*, int, std::size_t) { return false; }
+        void* front(int, std::size_t&) { return nullptr; }
+        void pop(int, std::size_t) {}
+        void set_sleeping(int, bool) {}
+        bool wake_needed(int, int) { return false; }
+    };
+#endif // STUBOUTMPI
+
 
     void RMI::RmiTask::process_some() {
 
@@ -69,14 +338,31 @@ namespace madness {
 
         // Now that the server thread doing other stuff (including being
         // responsible for its own outbound messages) we have to poll.
-        int narrived = 0, iterations = 0;
+        // If MPI is thread safe an idle server blocks in Waitsome after
+        // a few polls; a message arriving in shared memory wakes it up
+        // with an MPI message since it announced that it went to sleep.
+        int narrived = 0, nshm = 0, iterations = 0;
 
         MutexWaiter waiter;
-        while((narrived == 0) && (iterations < 1000)) {
-          narrived = SafeMPI::Request::Testsome(maxq_, recv_req.get(), ind.get(), status.get());
-          if (narrived) break;
+        while((narrived == 0) && (nshm == 0) && (iterations < 1000)) {
+          nshm = process_shm();
+          narrived = SafeMPI::Request::Testsome(maxq_+1, recv_req.get(), ind.get(), status.get());
+          if (narrived || nshm) break;
           ++iterations;
-          clear_send_req();
+          clear_send_req(stats);
+          if (blocking_ && iterations >= 10) {
+            if (shm) {
+              shm->set_sleeping(index, true);
+              nshm = process_shm();
+              if (nshm) {
+                shm->set_sleeping(index, false);
+                break;
+              }
+            }
+            narrived = SafeMPI::Request::Waitsome(maxq_+1, recv_req.get(), ind.get(), status.get());
+            if (shm) shm->set_sleeping(index, false);
+            break;
+          }
           myusleep(RMI::testsome_backoff_us);
         }
 
@@ -87,14 +373,21 @@ namespace madness {
         if (print_debug_info && narrived > 0)
             print_error(rank, ":RMI: ", narrived, " messages just arrived\n");
 
-        if (narrived) {
+        // Messages handled from shared memory may have made queued ones next in order
+        if (narrived || nshm) {
             for (int m=0; m<narrived; ++m) {
                 const int src = status[m].Get_source();
                 const size_t len = status[m].Get_count(MPI_BYTE);
                 const int i = ind[m];
 
-                ++(RMI::stats.nmsg_recv);
-                RMI::stats.nbyte_recv += len;
+                if (i == (int)maxq_) {
+                    // Woken up
+                    post_wake_recv();
+                    continue;
+                }
+
+                ++(stats.nmsg_recv);
+                stats.nbyte_recv += len;
 
                 const header* h = (const header*)(recv_buf[i]);
                 rmi_handlerT func = archive::to_abs_fn_ptr<rmi_handlerT>(h->func);
@@ -110,8 +403,10 @@ namespace madness {
                                   " count=", count, "\n");
 
                     if (is_ordered(attr)) ++(recv_counters[src]);
-                    func(recv_buf[i], len);
-                    post_recv_buf(i);
+                    if (!is_ordered(attr) && len > handoff_len_)
+                        handoff(func, i, len);
+                    else
+                        invoke(func, i, len);
                 }
                 else {
                   if (print_debug_info)
@@ -149,8 +444,7 @@ namespace madness {
                                 " count=", q[m].count, "\n");
 
                   ++(recv_counters[src]);
-                  q[m].func(recv_buf[q[m].i], q[m].len);
-                  post_recv_buf(q[m].i);
+                  invoke(q[m].func, q[m].i, q[m].len);
                 }
                 else {
                     q[nleftover++] = q[m];
@@ -172,10 +466,97 @@ namespace madness {
             // aggregates task submission.
             ThreadPool::instance()->flush_prebuf();
 #endif
-            clear_send_req();
+            clear_send_req(stats);
         }
     }
 
+    int RMI::RmiTask::process_shm() {
+        if (!shm) return 0;
+
+        const bool print_debug_info = RMI::debugging;
+        int ninvoked = 0;
+        for (int s=0; s<shm->size(); ++s) {
+            const ProcessID src = shm->comm_rank(s);
+            if (src % nthread != index) continue; // Another server handles src
+            for (std::size_t n=0; n<maxq_; ++n) {
+                size_t len;
+                void* buf = shm->front(s, len);
+                if (!buf) break;
+
+                const header* h = (const header*)(buf);
+                rmi_handlerT func = archive::to_abs_fn_ptr<rmi_handlerT>(h->func);
+                const attrT attr = h->attr;
+                const counterT count = (attr>>16);
+
+                // The ring is in order, so an ordered message that is not
+                // next waits for its predecessors, which come through MPI
+                if (is_ordered(attr) && count != recv_counters[src]) break;
+
+                ++(stats.nmsg_recv);
+                stats.nbyte_recv += len;
+
+                if (print_debug_info)
+                  print_error(rank, ":RMI: invoking from shm from=", src,
+                              " nbyte=", len, " func=", func,
+                              " ordered=", is_ordered(attr),
+                              " count=", count, "\n");
+
+                if (is_ordered(attr)) ++(recv_counters[src]);
+                if (!is_ordered(attr) && len > handoff_len_) {
+                    std::shared_ptr<void> owner = copy_message(buf, len);
+                    shm->pop(s, len);
+                    ThreadPool::add(new HandlerTask(func, owner, len));
+                }
+                else {
+                    func(buf, len);
+                    shm->pop(s, len);
+                }
+                ++ninvoked;
+            }
+        }
+        return ninvoked;
+    }
+
+    void RMI::RmiTask::invoke(rmi_handlerT func, int i, size_t len) {
+        if (i == (int)nrecv_) {
+            // A huge message has a buffer of its own that the handler may keep
+            std::shared_ptr<void>& owner = recv_buf_owner_accessor();
+            owner.reset(recv_buf[i], &free);
+            func(recv_buf[i], len);
+            recv_buf[i] = 0;
+            owner.reset();
+            post_pending_huge_msg();
+        }
+        else {
+            func(recv_buf[i], len);
+            post_recv_buf(i);
+        }
+    }
+
+    void RMI::RmiTask::handoff(rmi_handlerT func, int i, size_t len) {
+        // The task owns the buffer of a huge message or a copy of a recv
+        // buffer, which can then be reused right away
+        std::shared_ptr<void> owner;
+        if (i == (int)nrecv_) {
+            owner.reset(recv_buf[i], &free);
+            recv_buf[i] = 0;
+            post_pending_huge_msg();
+        }
+        else {
+            owner = copy_message(recv_buf[i], len);
+            post_recv_buf(i);
+        }
+        ThreadPool::add(new HandlerTask(func, owner, len));
+    }
+
+    void RMI::RmiTask::wake(ProcessID dest) const {
+        comm.Send(nullptr, 0, MPI_BYTE, dest, SafeMPI::RMI_WAKE_TAG);
+    }
+
+    void RMI::RmiTask::post_wake_recv() {
+        recv_req[maxq_] = comm.Irecv(nullptr, 0, MPI_BYTE, MPI_ANY_SOURCE, SafeMPI::RMI_WAKE_TAG);
+    }
+
     void RMI::RmiTask::post_pending_huge_msg() {
         if (recv_buf[nrecv_]) return;      // Message already pending
         if (!hugeq.empty()) {
@@ -221,18 +602,22 @@ namespace madness {
         //for (int i=0; i<nrecv_; ++i) free(recv_buf[i]);
     }
 
-    static std::atomic<bool> rmi_task_is_running = false;
+    static std::atomic<int> rmi_tasks_running = 0;
 
-    RMI::RmiTask::RmiTask(const SafeMPI::Intracomm& _comm)
+    RMI::RmiTask::RmiTask(const SafeMPI::Intracomm& _comm, int index, int nthread)
             : comm(_comm.Clone())
             , nproc(comm.Get_size())
             , rank(comm.Get_rank())
+            , index(index)
+            , nthread(nthread)
             , finished(false)
             , send_counters(new counterT[nproc])
             , recv_counters(new counterT[nproc])
             , max_msg_len_(DEFAULT_MAX_MSG_LEN)
             , nrecv_(DEFAULT_NRECV)
             , maxq_(DEFAULT_NRECV + 1)
+            , handoff_len_(0)
+            , blocking_(false)
             , recv_buf()
             , recv_req()
             , status()
@@ -296,6 +681,10 @@ namespace madness {
             maxq_ = nrecv_ + 1;
         }
 
+        // The receive buffers are partitioned among the server threads
+        nrecv_ = std::max(nrecv_/nthread, std::size_t(16));
+        maxq_ = nrecv_ + 1;
+
         // Get environment variable controlling use of synchronous send (MAD_NSSEND)
         // negative=sends synchronous message every MAD_RECV_BUFFER sends (default)
         //        0=never send synchronous message
@@ -310,17 +699,40 @@ namespace madness {
             }
         }
 
+        // Get the length above which unordered messages are handled by the
+        // thread pool from the MAD_RMI_HANDOFF_SIZE environment variable (in
+        // bytes, default is the size of the recv buffers)
+        handoff_len_ = max_msg_len_;
+        const char* mad_rmi_handoff_size = getenv("MAD_RMI_HANDOFF_SIZE");
+        if (mad_rmi_handoff_size) {
+            std::stringstream ss(mad_rmi_handoff_size);
+            ss >> handoff_len_;
+        }
+
+        // Waiting for messages blocks in MPI if it is thread safe, unless
+        // the MAD_RMI_BLOCKING environment variable is 0
+#ifndef MADNESS_SERIALIZES_MPI
+        blocking_ = (nproc > 1);
+        const char* mad_rmi_blocking = getenv("MAD_RMI_BLOCKING");
+        if (mad_rmi_blocking) {
+            std::stringstream ss(mad_rmi_blocking);
+            int flag = 1;
+            ss >> flag;
+            if (flag == 0) blocking_ = false;
+        }
+#endif // MADNESS_SERIALIZES_MPI
+
         // Allocate memory for receive buffer and requests
         recv_buf.reset(new void*[maxq_]);
-        recv_req.reset(new Request[maxq_]);
+        recv_req.reset(new Request[maxq_+1]);
 
         // Initialize the send/recv counts
         std::fill_n(send_counters.get(), nproc, 0);
         std::fill_n(recv_counters.get(), nproc, 0);
 
         // Allocate buffers for message tracking
-        status.reset(new SafeMPI::Status[maxq_]);
-        ind.reset(new int[maxq_]);
+        status.reset(new SafeMPI::Status[maxq_+1]);
+        ind.reset(new int[maxq_+1]);
         q.reset(new qmsg[maxq_]);
         MADNESS_ASSERT(maxq_ <= 1<<14);  // 16 bit task counter is sufficient to ensure that up to 2^14 tasks can be
                                          // pending per rank .. although maxq_ controls the TOTAL queue size, do this
@@ -335,6 +747,7 @@ namespace madness {
             }
             recv_buf[nrecv_] = 0;
         }
+        if (blocking_) post_wake_recv();
     }
 
 
@@ -350,12 +763,15 @@ namespace madness {
         // the worst case is where only one node sends huge messages to every node in the communicator
         // AND it has enough threads to use up all tags
         // NB list::size() is O(1) in c++11, but O(N) in older libstdc++
+        // the server receiving the huge message is the one handling this
+        RmiTask* task = this_task_accessor();
+        MADNESS_ASSERT(task);
         bool OK = (ThreadPool::size() < size_t(RMI::RmiTask::unique_tag_period()) ||
-                   RMI::task_ptr->hugeq.size() <
-                   std::size_t(RMI::RmiTask::unique_tag_period() / RMI::task_ptr->comm.Get_size()));
+                   task->hugeq.size() <
+                   std::size_t(RMI::RmiTask::unique_tag_period() / task->comm.Get_size()));
         if (!OK) MADNESS_EXCEPTION("huge_msg_handler paranoid test failing", RMI::RmiTask::unique_tag_period());
-        RMI::task_ptr->hugeq.push_back(std::make_tuple(src, nbyte, tag));
-        RMI::task_ptr->post_pending_huge_msg();
+        task->hugeq.push_back(std::make_tuple(src, nbyte, tag));
+        task->post_pending_huge_msg();
     }
 
     namespace detail {
@@ -405,31 +821,89 @@ namespace madness {
             }
 
             MADNESS_ASSERT(task_ptr == nullptr);
-            task_ptr.reset(new RmiTask(comm));
+
+            // Get the number of server threads from the MAD_NUM_RMI_THREADS
+            // environment variable; all processes must agree on it
+            int nthread = 1;
+            const char* mad_num_rmi_threads = getenv("MAD_NUM_RMI_THREADS");
+            if (mad_num_rmi_threads) {
+                std::stringstream ss(mad_num_rmi_threads);
+                ss >> nthread;
+                if (nthread < 1) nthread = 1;
+                if (nthread > 16) nthread = 16;
+            }
+            const int nproc = comm.Get_size();
+            if (nproc > 1) comm.Allreduce(MPI_IN_PLACE, &nthread, 1, MPI_INT, MPI_MIN);
+
+            for (int t=0; t<nthread; ++t) tasks.emplace_back(new RmiTask(comm, t, nthread));
+            task_ptr = tasks[comm.Get_rank() % nthread].get();
+
+#ifndef STUBOUTMPI
+            // Get the size of the intra-node shared-memory rings from the
+            // MAD_SHM_BUFFER_SIZE environment variable (in bytes, 0 disables them)
+            unsigned long shm_len = DEFAULT_SHM_RING_LEN;
+            const char* mad_shm_buffer_size = getenv("MAD_SHM_BUFFER_SIZE");
+            if (mad_shm_buffer_size) {
+                std::stringstream ss(mad_shm_buffer_size);
+                ss >> shm_len;
+            }
+
+            // Ranks on the same node exchange messages through shared memory;
+            // all ranks must agree on the ring size since setting up is collective
+            if (nproc > 1) {
+                comm.Allreduce(MPI_IN_PLACE, &shm_len, 1, MPI_UNSIGNED_LONG, MPI_MIN);
+                if (shm_len >= 4*HEADER_LEN) {
+                    SafeMPI::Intracomm nodecomm = comm.Split_type(SafeMPI::Intracomm::SHARED_SPLIT_TYPE, comm.Get_rank());
+                    if (nodecomm.Get_size() > 1) {
+                        std::shared_ptr<RmiTask::ShmTransport> shm(
+                            new RmiTask::ShmTransport(comm, nodecomm, shm_len, task_ptr->max_msg_len_, nthread));
+                        for (auto& t : tasks) t->shm = shm;
+                    }
+                }
+            }
+#endif // STUBOUTMPI
 
 #if HAVE_INTEL_TBB
-            ThreadPool::tbb_arena->enqueue([]{
-                task_ptr->run();
-            });
+            for (auto& t : tasks) {
+                RmiTask* task = t.get();
+                ThreadPool::tbb_arena->enqueue([task]{
+                    task->run();
+                });
+            }
 
             //TODO: is it needed ?
             task_ptr->comm.Barrier();
 
-            while (!rmi_task_is_running) {
+            while (rmi_tasks_running < nthread) {
               myusleep(100000);
             }
 #else
-            task_ptr->start();
+            for (auto& t : tasks) t->start();
 #endif // HAVE_INTEL_TBB
         }
 
 
+    bool RMI::is_node_local(ProcessID dest) {
+        return task_ptr && task_ptr->shm && task_ptr->shm->node_rank(dest) >= 0;
+    }
+
     void RMI::RmiTask::set_rmi_task_is_running(bool flag) {
-        rmi_task_is_running = flag; // Yipeeeeeeeeeeeeeeeeeeeeee ... fighting TBB laziness
+        rmi_tasks_running += flag ? 1 : -1; // Yipeeeeeeeeeeeeeeeeeeeeee ... fighting TBB laziness
     }
 
     RMI::Request
     RMI::RmiTask::RmiTask::isend(const void* buf, size_t nbyte, ProcessID dest, rmi_handlerT func, attrT attr) {
+        const RMIBlock block = {buf, nbyte};
+        return isend(&block, 1, dest, func, attr);
+    }
+
+    RMI::Request
+    RMI::RmiTask::RmiTask::isend(const RMIBlock* blocks, int nblock, ProcessID dest, rmi_handlerT func, attrT attr) {
+
+        MADNESS_ASSERT(nblock > 0);
+        const void* buf = blocks[0].ptr;
+        size_t nbyte = 0;
+        for (int b=0; b<nblock; ++b) nbyte += blocks[b].nbyte;
 
         MADNESS_ASSERT(nbyte <= std::numeric_limits<int>::max());
 
@@ -456,8 +930,8 @@ namespace madness {
             waiter.reset();
             while (!req_ack.Test()) waiter.wait();
         }
-        else if (nbyte < HEADER_LEN) {
-            MADNESS_EXCEPTION("RMI::isend --- your buffer is too small to hold the header", static_cast<int>(nbyte));
+        else if (blocks[0].nbyte < HEADER_LEN) {
+            MADNESS_EXCEPTION("RMI::isend --- your buffer is too small to hold the header", static_cast<int>(blocks[0].nbyte));
         }
 
         if (RMI::debugging)
@@ -482,22 +956,54 @@ namespace madness {
         h->func = archive::to_rel_fn_ptr(func);
         h->attr = attr;
 
-        ++(RMI::stats.nmsg_sent);
-        RMI::stats.nbyte_sent += nbyte;
+        ++(stats.nmsg_sent);
+        stats.nbyte_sent += nbyte;
+
+        // Messages to ranks on this node go through shared memory, unless
+        // they are too long or the ring is full
+        if (shm && nbyte <= shm->max_msg_len()) {
+            const int d = shm->node_rank(dest);
+            if (d >= 0 && shm->push(d, blocks, nblock, nbyte)) {
+                ++(stats.nmsg_sent_shm);
+                stats.nbyte_sent_shm += nbyte;
+                // This server's index is that of the one handling me at dest
+                if (shm->wake_needed(d, index)) wake(dest);
+                unlock();
+                return Request();
+            }
+        }
 
+        // A gathered message is sent as one element of a datatype made of
+        // its blocks, which matches the contiguous bytes posted by the receiver
+        const void* sendbuf = buf;
+        int count = nbyte;
+        MPI_Datatype type = MPI_BYTE;
+        if (nblock > 1) {
+            std::unique_ptr<int[]> lengths(new int[nblock]);
+            std::unique_ptr<MPI_Aint[]> addresses(new MPI_Aint[nblock]);
+            for (int b=0; b<nblock; ++b) {
+                lengths[b] = blocks[b].nbyte;
+                addresses[b] = SafeMPI::Get_address(blocks[b].ptr);
+            }
+            type = SafeMPI::Type_create_hindexed_bytes(nblock, lengths.get(), addresses.get());
+            sendbuf = MPI_BOTTOM;
+            count = 1;
+        }
 
         numsent++;
         Request result;
         if (nssend_ && numsent==std::size_t(nssend_)) {
-            result = comm.Issend(buf, nbyte, MPI_BYTE, dest, tag);
+            result = comm.Issend(sendbuf, count, type, dest, tag);
             numsent %= nssend_;
         }
         else {
-            result = comm.Isend(buf, nbyte, MPI_BYTE, dest, tag);
+            result = comm.Isend(sendbuf, count, type, dest, tag);
         }
 
         unlock();
 
+        if (nblock > 1) SafeMPI::Type_free(type);
+
         return result;
     }
 
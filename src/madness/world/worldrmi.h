@@ -41,13 +41,17 @@
 #include <list>
 #include <memory>
 #include <tuple>
+#include <vector>
 #include <pthread.h>
 #include <madness/world/print.h>
 
 /*
-  There is just one server thread and it is the only one
-  messing with the recv buffers, so there is no need for
-  mutex on recv related data.
+  There are one or more server threads (MAD_NUM_RMI_THREADS, default 1),
+  each with its own clone of the communicator, recv buffers and message
+  queue, so there is no need for mutex on recv related data. A process
+  sends all its messages through the server of index rank%nthread, so
+  that the messages from one source always arrive at the same server of
+  the destination and stay in order.
 
   Multiple threads (including the server) may send hence
   we need to be careful about send-related data.
@@ -63,6 +67,26 @@
   MPI_Comm_group and then creating a map from ranks in
   comm to ranks in world using MPI_Group_translate_ranks.
 
+  When MPI is MPI_THREAD_MULTIPLE an idle server blocks in Waitsome
+  instead of polling with a backoff (disable with MAD_RMI_BLOCKING=0). It
+  is woken by an MPI message, including a zero-byte one on RMI_WAKE_TAG
+  that a sender writing into the shared memory rings sends if the server
+  announced that it went to sleep.
+
+  Unordered messages longer than MAD_RMI_HANDOFF_SIZE (default: the recv
+  buffer size) are handled by a task in the thread pool rather than by the
+  server thread.
+
+  Ranks that share a node also exchange messages through lock-free
+  single-producer/single-consumer rings in an MPI-3 shared memory window.
+  The senders to one ring are serialized by the RmiTask mutex, and the
+  server thread of the receiving rank is the only consumer. Handlers are
+  invoked directly on the ring memory, which is reused after the handler
+  returns, just like the recv buffers. Ordered messages keep one counter
+  per pair of ranks across both transports, so an ordered message at the
+  front of a ring waits there until its predecessors, sent with MPI
+  because they were long or found the ring full, have been handled.
+
   The class is a singleton ... i.e., there is only one instance of it
   that is made the first time that you call RMI::instance().
 
@@ -78,6 +102,19 @@
   - RMI::Request has the same interface as SafeMPI::Request
   (right now it is a SafeMPI::Request but this is not guaranteed)
 
+  RMI::Request RMI::isend(const RMIBlock* blocks, int nblock, int dest,
+                          rmi_handlerT func, unsigned int attr=0)
+  - to send an asynchronous message gathered from several blocks of memory
+  (the first one starts with the header); the receiver gets one contiguous
+  message
+
+  const std::shared_ptr<void>& RMI::get_recv_buffer_owner()
+  - in a handler, owner of the buffer of the huge message being handled,
+  which the handler may keep alive instead of copying data out of it
+
+  bool RMI::is_node_local(int dest)
+  - true if messages to dest go through intra-node shared memory
+
   void RMI::begin()
   - to start the server thread
 
@@ -150,9 +187,18 @@ namespace madness {
         uint64_t nmsg_recv;
         uint64_t nbyte_recv;
         uint64_t max_serv_send_q;
+        uint64_t nmsg_sent_shm;  //!< messages sent through the intra-node shared-memory rings
+        uint64_t nbyte_sent_shm;
 
         RMIStats()
-            : nmsg_sent(0), nbyte_sent(0), nmsg_recv(0), nbyte_recv(0), max_serv_send_q(0) {}
+            : nmsg_sent(0), nbyte_sent(0), nmsg_recv(0), nbyte_recv(0), max_serv_send_q(0)
+            , nmsg_sent_shm(0), nbyte_sent_shm(0) {}
+    };
+
+    /// A contiguous block of memory that is part of a message
+    struct RMIBlock {
+        const void* ptr;
+        size_t nbyte;
     };
 
     /// This for RMI server thread to manage lifetime of WorldAM messages that it is sending
@@ -185,11 +231,11 @@ namespace madness {
         static void set_this_thread_is_server(bool flag = true) { is_server_thread_accessor() = flag;}
         static bool get_this_thread_is_server() {return is_server_thread_accessor();}
 
-        static std::list< std::unique_ptr<RMISendReq> > send_req; // List of outstanding world active messages sent by the server
+        static thread_local std::list< std::unique_ptr<RMISendReq> > send_req; // List of outstanding world active messages sent by this server thread
 
     private:
 
-        static void clear_send_req() {
+        static void clear_send_req(RMIStats& stats) {
             //std::cout << "clearing server messages " << pthread_self() << std::endl;
             stats.max_serv_send_q = std::max(stats.max_serv_send_q,uint64_t(send_req.size()));
             auto it=send_req.begin();
@@ -222,6 +268,8 @@ namespace madness {
             SafeMPI::Intracomm comm;
             const int nproc;            // No. of processes in comm world
             const ProcessID rank;       // Rank of this process
+            const int index;            // Index of this server thread
+            const int nthread;          // No. of server threads in each process
             std::atomic<bool> finished;     // True if finished ... atomic seems preferable to volatile
             std::unique_ptr<counterT[]> send_counters; // used to be volatile but no need
             std::unique_ptr<counterT[]> recv_counters;
@@ -229,30 +277,51 @@ namespace madness {
             std::size_t nrecv_;
             long nssend_;
             std::size_t maxq_;
+            std::size_t handoff_len_;   // Unordered messages longer than this are handled by the thread pool
+            bool blocking_;             // True if waiting for messages blocks in MPI
             std::unique_ptr<void*[]> recv_buf; // Will be at least ALIGNMENT aligned ... +1 for huge messages
-            std::unique_ptr<SafeMPI::Request[]> recv_req;
+            std::unique_ptr<SafeMPI::Request[]> recv_req; // ... +1 for the wakeup message
 
             std::unique_ptr<SafeMPI::Status[]> status;
             std::unique_ptr<int[]> ind;
             std::unique_ptr<qmsg[]> q;
             int n_in_q;
+            RMIStats stats;
+
+            class HandlerTask;
+            class ShmTransport;
+            std::shared_ptr<ShmTransport> shm; // Rings to the other ranks on this node, or null
 
             static inline bool is_ordered(attrT attr) { return attr & ATTR_ORDERED; }
 
             void process_some();
 
-            RmiTask(const SafeMPI::Intracomm& comm = SafeMPI::COMM_WORLD);
+            int process_shm();
+
+            void invoke(rmi_handlerT func, int i, size_t len);
+
+            void handoff(rmi_handlerT func, int i, size_t len);
+
+            RmiTask(const SafeMPI::Intracomm& comm, int index, int nthread);
             virtual ~RmiTask();
 
+            /// @return reference to the server this thread is running, or null
+            static RmiTask*& this_task_accessor();
+
+            /// @return reference to the owner of the buffer of the message being handled by this thread
+            static std::shared_ptr<void>& recv_buf_owner_accessor();
+
             static void set_rmi_task_is_running(bool flag = true);
 
 #if HAVE_INTEL_TBB
             void run() {
                 set_rmi_task_is_running(true);
                 RMI::set_this_thread_is_server(true);
+                this_task_accessor() = this;
 
                 while (! finished) process_some();
 
+                this_task_accessor() = nullptr;
                 RMI::set_this_thread_is_server(false);
                 set_rmi_task_is_running(false);
 
@@ -262,6 +331,7 @@ namespace madness {
 #else
             void run() {
                 RMI::set_this_thread_is_server(true);
+                this_task_accessor() = this;
                 try {
                     while (! finished) process_some();
                     finished = false;
@@ -270,6 +340,7 @@ namespace madness {
                     RMI::set_this_thread_is_server(false);
                     throw;
                 }
+                this_task_accessor() = nullptr;
                 RMI::set_this_thread_is_server(false);
             }
 #endif // HAVE_INTEL_TBB
@@ -278,16 +349,23 @@ namespace madness {
                 if (debugging)
                   print_error(rank, ":RMI: sending exit request to server thread\n");
 
-                // Set finished flag
+                // Set finished flag and wake up the server if it is waiting in MPI
                 finished = true;
+                if (blocking_) wake(rank);
                 while(finished)
                     myusleep(1000);
             }
 
+            void wake(ProcessID dest) const;
+
+            void post_wake_recv();
+
             static void huge_msg_handler(void *buf, size_t nbytein);
 
             Request isend(const void* buf, size_t nbyte, ProcessID dest, rmi_handlerT func, attrT attr);
 
+            Request isend(const RMIBlock* blocks, int nblock, ProcessID dest, rmi_handlerT func, attrT attr);
+
             void post_pending_huge_msg();
 
             void post_recv_buf(int i);
@@ -304,12 +382,13 @@ namespace madness {
         }; // class RmiTask
 
 
-        static std::unique_ptr<RmiTask> task_ptr;    // Pointer to the singleton instance
-        static RMIStats stats;
+        static std::vector< std::unique_ptr<RmiTask> > tasks; // The server threads
+        static RmiTask* task_ptr;    // The server this process sends through
         static bool debugging;    // True if debugging ... used to be volatile but no need
 
         static const size_t DEFAULT_MAX_MSG_LEN = 3*512*1024;  //!< the default size of recv buffers, in bytes; the actual size can be configured by the user via envvar MAD_BUFFER_SIZE
         static const int DEFAULT_NRECV = 128;  //!< the default # of recv buffers; the actual number can be configured by the user via envvar MAD_RECV_BUFFERS
+        static const size_t DEFAULT_SHM_RING_LEN = 1024*1024;  //!< the default size of each intra-node shared-memory ring, in bytes; can be configured by the user via envvar MAD_SHM_BUFFER_SIZE (0 disables the rings)
 
         // Not allowed
         RMI(const RMI&);
@@ -334,13 +413,35 @@ namespace madness {
         /// Returns the number of recv buffers
 
         /// @return The number of recv buffers
-        /// @note The default value is given by RMI::DEFAULT_NRECV, can be overridden at runtime by the user via environment variable MAD_RECV_BUFFERS
+        /// @note The default value is given by RMI::DEFAULT_NRECV, can be overridden at runtime by the user via environment variable MAD_RECV_BUFFERS;
+        ///       the buffers are partitioned among the server threads
         /// @warning Cannot be smaller than 32.
         static std::size_t nrecv() {
             MADNESS_ASSERT(task_ptr);
-            return task_ptr->nrecv_;
+            std::size_t n = 0;
+            for (const auto& t : tasks) n += t->nrecv_;
+            return n;
+        }
+
+        /// Returns the number of server threads
+
+        /// @return The number of server threads
+        /// @note The default value is 1, can be overridden at runtime by the user via environment variable MAD_NUM_RMI_THREADS
+        static int nthread() {
+            MADNESS_ASSERT(task_ptr);
+            return task_ptr->nthread;
         }
 
+        /// Returns true if messages to @p dest go through intra-node shared memory
+
+        /// Ranks on the same node exchange messages that are not longer than
+        /// a quarter of the ring size through lock-free shared-memory rings,
+        /// bypassing MPI; longer messages, and messages that find the ring
+        /// full, are sent with MPI. The rings are set up by RMI::begin() from
+        /// the node topology of the communicator.
+        /// @param[in] dest The destination process
+        static bool is_node_local(ProcessID dest);
+
         /// Send a remote method invocation (again you should probably be looking at worldam.h instead)
 
         /// @param[in] buf Pointer to the data buffer (do not modify until send is completed)
@@ -348,7 +449,8 @@ namespace madness {
         /// @param[in] dest Process to receive the message
         /// @param[in] func The function to handle the message on the remote end
         /// @param[in] attr Attributes of the message (ATTR_UNORDERED or ATTR_ORDERED)
-        /// @return The status as an RMI::Request that presently is a SafeMPI::Request
+        /// @return The status as an RMI::Request that presently is a SafeMPI::Request;
+        ///    a message delivered into shared memory returns a null request
         static Request
         isend(const void* buf, size_t nbyte, ProcessID dest, rmi_handlerT func, unsigned int attr=ATTR_UNORDERED) {
             if(!task_ptr) {
@@ -360,6 +462,39 @@ namespace madness {
             return task_ptr->isend(buf, nbyte, dest, func, attr);
         }
 
+        /// Send a remote method invocation gathered from several blocks of memory
+
+        /// The receiver gets the concatenation of the blocks as one
+        /// message, without it being copied into a contiguous buffer first.
+        /// @param[in] blocks The blocks of the message; the first one holds the header (do not modify until send is completed)
+        /// @param[in] nblock The number of blocks
+        /// @param[in] dest Process to receive the message
+        /// @param[in] func The function to handle the message on the remote end
+        /// @param[in] attr Attributes of the message (ATTR_UNORDERED or ATTR_ORDERED)
+        /// @return The status as an RMI::Request that presently is a SafeMPI::Request
+        static Request
+        isend(const RMIBlock* blocks, int nblock, ProcessID dest, rmi_handlerT func, unsigned int attr=ATTR_UNORDERED) {
+            if(!task_ptr) {
+              MADNESS_EXCEPTION("!! MADNESS error: The RMI thread is not running", (task_ptr != nullptr));
+            }
+            return task_ptr->isend(blocks, nblock, dest, func, attr);
+        }
+
+        /// Owner of the buffer of the message being handled by this thread
+
+        /// Huge messages (longer than max_msg_len()) are received into a
+        /// buffer of their own, which is owned by a shared pointer while the
+        /// handler runs; a handler can keep data in the buffer alive, e.g.
+        /// large tensors, by copying this pointer instead of copying the
+        /// data. The recv buffers of other messages are reused. Handlers
+        /// running in the thread pool also own their buffer.
+        /// @return The owner of the buffer, or null if the message was
+        ///    received into a reused buffer or if this thread is not
+        ///    handling a message
+        static const std::shared_ptr<void>& get_recv_buffer_owner() {
+            return RmiTask::recv_buf_owner_accessor();
+        }
+
         /// will complain to std::cerr and throw if ASLR is on by making
         /// sure that address of this function matches across @p comm
         /// @param[in] comm the communicator
@@ -369,9 +504,10 @@ namespace madness {
 
         static void end() {
             if(task_ptr) {
-                task_ptr->exit();
-                //exit insures that RMI task is completed, therefore it is OK to delete it
+                for (auto& t : tasks) t->exit();
+                //exit insures that RMI tasks are completed, therefore it is OK to delete them
                 task_ptr = nullptr;
+                tasks.clear();
             }
         }
 
@@ -379,7 +515,20 @@ namespace madness {
 
         static bool get_debug() { return debugging; }
 
-        static const RMIStats& get_stats() { return stats; }
+        /// @return The message passing statistics summed over the server threads
+        static RMIStats get_stats() {
+            RMIStats sum;
+            for (const auto& t : tasks) {
+                sum.nmsg_sent += t->stats.nmsg_sent;
+                sum.nbyte_sent += t->stats.nbyte_sent;
+                sum.nmsg_recv += t->stats.nmsg_recv;
+                sum.nbyte_recv += t->stats.nbyte_recv;
+                sum.max_serv_send_q = std::max(sum.max_serv_send_q, t->stats.max_serv_send_q);
+                sum.nmsg_sent_shm += t->stats.nmsg_sent_shm;
+                sum.nbyte_sent_shm += t->stats.nbyte_sent_shm;
+            }
+            return sum;
+        }
     }; // class RMI
 
 } // namespace madness